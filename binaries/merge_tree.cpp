@@ -7,19 +7,20 @@
 
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <boost/lexical_cast.hpp>
 #include <util/ProgramOptions.h>
 #include <util/Logger.h>
 #include <util/exceptions.h>
 #include <util/helpers.hpp>
 #include <vigra/impex.hxx>
 #include <vigra/multi_array.hxx>
-#include <vigra/slic.hxx>
-#include <vigra/multi_convolution.hxx>
 #include <mergetree/IterativeRegionMerging.h>
+#include <mergetree/TiledRegionMerging.h>
 #include <mergetree/MedianEdgeIntensity.h>
-#include <mergetree/SmallFirst.h>
-#include <mergetree/MultiplyMinRegionSize.h>
-#include <mergetree/RandomPerturbation.h>
+#include <mergetree/Superpixels.h>
+#include <mergetree/Merging.h>
+#include <mergetree/MergeTreeEnsemble.h>
 
 util::ProgramOption optionSourceImage(
 		util::_long_name        = "source",
@@ -33,6 +34,11 @@ util::ProgramOption optionMergeTreeImage(
 		util::_description_text = "An image representing the merge tree.",
 		util::_default_value    = "mergetree.png");
 
+util::ProgramOption optionMergeHistory(
+		util::_long_name        = "mergeHistory",
+		util::_description_text = "A file to write the merge history to, i.e., the initial superpixels and the list of merges. multi2cut reads this file faster than the merge-tree image. "
+		                          "With tileSize, the merge-tree image is not written.");
+
 util::ProgramOption optionSuperpixelImage(
 		util::_long_name        = "superpixelImage",
 		util::_description_text = "Image with the initial superpixels.",
@@ -51,24 +57,6 @@ util::ProgramOption optionSmooth(
 		util::_long_name        = "smooth",
 		util::_description_text = "Smooth the input image with a Gaussian kernel of the given stddev.");
 
-util::ProgramOption optionSlicSuperpixels(
-		util::_long_name        = "slicSuperpixels",
-		util::_description_text = "Use SLIC superpixels instead of watersheds to obtain initial regions.");
-
-util::ProgramOption optionSlicIntensityScaling(
-		util::_long_name        = "slicIntensityScaling",
-		util::_description_text = "How to scale the image intensity for comparison to spatial distance. Default is 1.0.",
-		util::_default_value    = 1.0);
-
-util::ProgramOption optionSliceSize(
-		util::_long_name        = "slicSize",
-		util::_description_text = "An upper limit on the SLIC superpixel size. Default is 10.",
-		util::_default_value    = 10);
-
-util::ProgramOption optionMergeSmallRegionsFirst(
-		util::_long_name        = "mergeSmallRegionsFirst",
-		util::_description_text = "Merge small regions first. For parameters, see smallRegionThreshold1, smallRegionThreshold2, and intensityThreshold.");
-
 util::ProgramOption optionRandomPerturbation(
 		util::_long_name        = "randomPerturbation",
 		util::_short_name       = "r",
@@ -98,6 +86,49 @@ readImage(std::string filename) {
 	return image;
 }
 
+/**
+ * Get the filename for the i-th tree of an ensemble, by appending "_i" to the 
+ * name before the extension.
+ */
+std::string
+ensembleFilename(std::string filename, unsigned int i) {
+
+	std::string::size_type dot   = filename.find_last_of('.');
+	std::string::size_type slash = filename.find_last_of('/');
+
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		dot = filename.size();
+
+	return filename.substr(0, dot) + "_" + boost::lexical_cast<std::string>(i) + filename.substr(dot);
+}
+
+void
+exportSuperpixels(vigra::MultiArrayView<2, int> initialRegions) {
+
+	vigra::exportImage(
+			initialRegions,
+			vigra::ImageExportInfo(optionSuperpixelImage.as<std::string>().c_str()));
+
+	vigra::MultiArray<2, int> initialRegionsWithBorders(initialRegions.shape());
+	initialRegionsWithBorders = initialRegions;
+
+	for (unsigned int y = 0; y < initialRegions.height() - 1; y++)
+		for (unsigned int x = 0; x < initialRegions.width() - 1; x++) {
+
+			float value = initialRegions(x, y);
+			float right = initialRegions(x+1, y);
+			float down  = initialRegions(x, y+1);
+			float diag  = initialRegions(x+1, y+1);
+
+			if (value != right || value != down || value != diag)
+				initialRegionsWithBorders(x, y) = 0;
+		}
+
+	vigra::exportImage(
+			initialRegionsWithBorders,
+			vigra::ImageExportInfo(optionSuperpixelWithBordersImage.as<std::string>().c_str()));
+}
+
 int main(int optionc, char** optionv) {
 
 	try {
@@ -116,111 +147,105 @@ int main(int optionc, char** optionv) {
 		vigra::MultiArray<2, float> image = readImage(optionSourceImage);
 
 		if (optionSmooth)
-			vigra::gaussianSmoothMultiArray(
-					image,
-					image,
-					optionSmooth.as<double>());
+			GaussianSmoothing()(image, optionSmooth.as<double>());
 
-		// perform watersheds or find SLIC superpixels
-		vigra::MultiArray<2, int> initialRegions(image.shape());
+		if (optionTileSize) {
 
-		if (optionSlicSuperpixels) {
+			if (optionEnsembleSize)
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"ensembles of merge trees can not be created with tiled merging");
 
-			unsigned int maxLabel = vigra::slicSuperpixels(
-					image,
-					initialRegions,
-					optionSlicIntensityScaling.as<double>(),
-					optionSliceSize.as<double>(),
-					vigra::SlicOptions().iterations(100));
+			// with a merge history, the merge-tree image is not written
+			TiledRegionMerging merging(image.shape(), optionMergeHistory);
 
-			LOG_USER(logger::out) << "found " << maxLabel << " SLIC superpixels" << std::endl;
+			merging.createInitialRegions(image, Superpixels());
 
-		} else {
+			if (!optionSlicSuperpixels)
+				exportSuperpixels(merging.getInitialRegions());
 
-			unsigned int maxLabel = vigra::watershedsMultiArray(
-					image,
-					initialRegions,
-					vigra::IndirectNeighborhood,
-					vigra::WatershedOptions().seedOptions(vigra::SeedOptions().extendedMinima()));
+			merging.createMergeTree(image, Merging(optionRandomPerturbation));
 
-			LOG_USER(logger::out) << "found " << maxLabel << " watershed regions" << std::endl;
+			if (optionMergeHistory) {
 
-			vigra::exportImage(
-					initialRegions,
-					vigra::ImageExportInfo(optionSuperpixelImage.as<std::string>().c_str()));
+				LOG_USER(logger::out) << "writing merge history..." << std::endl;
 
-			vigra::MultiArray<2, int> initialRegionsWithBorders(image.shape());
-			initialRegionsWithBorders = initialRegions;
+				MergeHistory(merging.getInitialRegions(), merging.getMerges()).write(optionMergeHistory.as<std::string>());
 
-			for (unsigned int y = 0; y < initialRegions.height() - 1; y++)
-				for (unsigned int x = 0; x < initialRegions.width() - 1; x++) {
+			} else {
 
-					float value = initialRegions(x, y);
-					float right = initialRegions(x+1, y);
-					float down  = initialRegions(x, y+1);
-					float diag  = initialRegions(x+1, y+1);
+				LOG_USER(logger::out) << "writing merge tree..." << std::endl;
 
-					if (value != right || value != down || value != diag)
-						initialRegionsWithBorders(x, y) = 0;
-				}
+				vigra::exportImage(
+						merging.getMergeTree(),
+						vigra::ImageExportInfo(optionMergeTreeImage.as<std::string>().c_str()).setPixelType("FLOAT"));
+			}
 
-			vigra::exportImage(
-					initialRegionsWithBorders,
-					vigra::ImageExportInfo(optionSuperpixelWithBordersImage.as<std::string>().c_str()));
+			return 0;
 		}
 
-		// extract merge tree
-		IterativeRegionMerging merging(initialRegions);
+		// perform watersheds or find SLIC superpixels
+		vigra::MultiArray<2, int> initialRegions(image.shape());
 
-		MedianEdgeIntensity mei(image);
+		unsigned int maxLabel = Superpixels()(image, initialRegions);
 
-		// create the RAG description for the median edge intensities
-		if (optionRagFile)
-			merging.storeRag(optionRagFile.as<std::string>(), mei);
-
-		if (optionMergeSmallRegionsFirst) {
+		if (optionSlicSuperpixels) {
 
-			SmallFirst<MedianEdgeIntensity> scoringFunction(
-					merging.getRag(),
-					image,
-					initialRegions,
-					mei);
+			LOG_USER(logger::out) << "found " << maxLabel << " SLIC superpixels" << std::endl;
 
-			if (optionRandomPerturbation) {
+		} else {
 
-				RandomPerturbation<SmallFirst<MedianEdgeIntensity> > rp(scoringFunction);
-				merging.createMergeTree(rp);
+			LOG_USER(logger::out) << "found " << maxLabel << " watershed regions" << std::endl;
 
-			} else {
+			exportSuperpixels(initialRegions);
+		}
 
-				merging.createMergeTree(scoringFunction);
-			}
+		if (optionEnsembleSize) {
 
-		} else {
+			MergeTreeEnsemble ensemble(image, initialRegions);
 
-			MultiplyMinRegionSize<MedianEdgeIntensity> scoringFunction(
-					merging.getRag(),
-					image,
-					initialRegions,
-					mei);
+			ensemble.createMergeTrees(optionEnsembleSize.as<unsigned int>());
 
-			if (optionRandomPerturbation) {
+			LOG_USER(logger::out) << "writing merge trees..." << std::endl;
 
-				RandomPerturbation<MultiplyMinRegionSize<MedianEdgeIntensity> > rp(scoringFunction);
-				merging.createMergeTree(rp);
+			for (unsigned int i = 0; i < ensemble.size(); i++) {
 
-			} else {
+				vigra::exportImage(
+						ensemble.getMergeTree(i),
+						vigra::ImageExportInfo(ensembleFilename(optionMergeTreeImage, i).c_str()).setPixelType("FLOAT"));
 
-				merging.createMergeTree(scoringFunction);
+				if (optionMergeHistory)
+					MergeHistory(initialRegions, ensemble.getMerges(i)).write(ensembleFilename(optionMergeHistory, i));
 			}
+
+			return 0;
+		}
+
+		// extract merge tree
+		IterativeRegionMerging merging(initialRegions, image);
+
+		// create the RAG description for the median edge intensities
+		if (optionRagFile) {
+
+			MedianEdgeIntensity mei(merging.getRag(), image);
+			merging.storeRag(optionRagFile.as<std::string>(), mei);
 		}
 
+		Merging(optionRandomPerturbation)(merging, image, std::numeric_limits<float>::max());
+
 		LOG_USER(logger::out) << "writing merge tree..." << std::endl;
 
 		vigra::exportImage(
 				merging.getMergeTree(),
 				vigra::ImageExportInfo(optionMergeTreeImage.as<std::string>().c_str()).setPixelType("FLOAT"));
 
+		if (optionMergeHistory) {
+
+			LOG_USER(logger::out) << "writing merge history..." << std::endl;
+
+			MergeHistory(initialRegions, merging.getMerges()).write(optionMergeHistory.as<std::string>());
+		}
+
 	} catch (Exception& e) {
 
 		handleException(e, std::cerr);
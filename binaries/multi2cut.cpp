@@ -18,6 +18,8 @@
 #include <io/SlicesWriter.h>
 #include <io/LearningProblemWriter.h>
 #include <slices/SlicesCollector.h>
+#include <slices/SliceIds.h>
+#include <parallel/ParallelFor.h>
 #include <inference/LinearSliceCostFunction.h>
 #include <inference/ProblemAssembler.h>
 #include <inference/LinearSolver.h>
@@ -71,6 +73,43 @@ util::ProgramOption optionDumpSlices(
 		util::_long_name        = "dumpSlices",
 		util::_description_text = "Store images and offset positions of all extracted candidates (slices).");
 
+util::ProgramOption optionReadMergeTreesInParallel(
+		util::_long_name        = "readMergeTreesInParallel",
+		util::_description_text = "Read and extract the slices of multiple merge trees concurrently. The slice ids are assigned "
+		                          "in the order of the merge-tree files afterwards.");
+
+/**
+ * Reads the slices and conflict sets of the i-th merge-tree reader.
+ */
+class MergeTreeReading {
+
+public:
+
+	MergeTreeReading(
+			std::vector<pipeline::Process<ReadMergeTreePipeline> >& readers,
+			std::vector<pipeline::Value<SlicesTree> >&              slices,
+			std::vector<pipeline::Value<ConflictSets> >&            conflictSets) :
+		_readers(readers),
+		_slices(slices),
+		_conflictSets(conflictSets) {}
+
+	void operator()(unsigned int i) const {
+
+		_slices[i]       = pipeline::Value<SlicesTree>(_readers[i]->getOutput("slices"));
+		_conflictSets[i] = pipeline::Value<ConflictSets>(_readers[i]->getOutput("conflict sets"));
+
+		// access the values to update the reader
+		_slices[i]->size();
+		_conflictSets[i]->size();
+	}
+
+private:
+
+	std::vector<pipeline::Process<ReadMergeTreePipeline> >& _readers;
+	std::vector<pipeline::Value<SlicesTree> >&              _slices;
+	std::vector<pipeline::Value<ConflictSets> >&            _conflictSets;
+};
+
 boost::shared_ptr<pipeline::SimpleProcessNode<> >
 getLoss(
 		std::string name,
@@ -268,6 +307,19 @@ int main(int optionc, char** optionv) {
 			}
 		}
 
+		if (optionReadMergeTreesInParallel && mergeTreeReaders.size() > 1) {
+
+			LOG_USER(out) << "[main] reading " << mergeTreeReaders.size() << " merge trees in parallel" << std::endl;
+
+			std::vector<pipeline::Value<SlicesTree> >   slices(mergeTreeReaders.size());
+			std::vector<pipeline::Value<ConflictSets> > conflictSets(mergeTreeReaders.size());
+
+			parallel::parallelFor(0, mergeTreeReaders.size(), MergeTreeReading(mergeTreeReaders, slices, conflictSets));
+
+			for (unsigned int i = 0; i < mergeTreeReaders.size(); i++)
+				SliceIds::renumber(*slices[i], *conflictSets[i]);
+		}
+
 		pipeline::Process<ImageReader>      rawImageReader(optionRawImage.as<std::string>());
 		pipeline::Process<ImageReader>      probabilityImageReader(optionProbabilityImage.as<std::string>());
 		pipeline::Process<FeatureExtractor> featureExtractor;
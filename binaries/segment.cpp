@@ -0,0 +1,146 @@
+/**
+ * segment
+ *
+ * Segments a section in one process: creates a merge tree for a boundary 
+ * prediction image, extracts its slices, and finds the best segmentation 
+ * with the given feature weights. This is equivalent to running merge_tree 
+ * and multi2cut (in inference mode), without the merge-tree images in 
+ * between. With --ensembleSize, several randomly perturbed merge trees are 
+ * created concurrently and their slices are collected.
+ */
+
+#include <iostream>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <pipeline/Process.h>
+#include <pipeline/Value.h>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include <util/helpers.hpp>
+#include <imageprocessing/io/ImageReader.h>
+
+#include <features/FeatureExtractor.h>
+#include <io/FeatureWeightsReader.h>
+#include <io/SolutionWriter.h>
+#include <slices/MergeTreeSliceExtractor.h>
+#include <slices/SlicesCollector.h>
+#include <mergetree/MergeTreeEnsemble.h>
+#include <inference/LinearSliceCostFunction.h>
+#include <inference/ProblemAssembler.h>
+#include <inference/LinearSolver.h>
+#include <inference/Reconstructor.h>
+
+util::ProgramOption optionRawImage(
+		util::_long_name        = "rawImage",
+		util::_short_name       = "r",
+		util::_description_text = "The raw image for feature extraction.",
+		util::_default_value    = "raw.png");
+
+util::ProgramOption optionProbabilityImage(
+		util::_long_name        = "probabilityImage",
+		util::_short_name       = "p",
+		util::_description_text = "The membrane probability image to compute the merge tree for, and for feature extraction.",
+		util::_default_value    = "probability.png");
+
+util::ProgramOption optionSolutionImage(
+		util::_long_name        = "solutionImage",
+		util::_description_text = "The image to write the segmentation to.",
+		util::_default_value    = "output_images/solution.tif");
+
+using namespace logger;
+
+int main(int optionc, char** optionv) {
+
+	try {
+
+		/********
+		 * INIT *
+		 ********/
+
+		// init command line parser
+		util::ProgramOptions::init(optionc, optionv);
+
+		// init logger
+		LogManager::init();
+
+		LOG_USER(out) << "[main] starting..." << std::endl;
+
+		pipeline::Process<ImageReader>             rawImageReader(optionRawImage.as<std::string>());
+		pipeline::Process<ImageReader>             probabilityImageReader(optionProbabilityImage.as<std::string>());
+		pipeline::Process<MergeTreeSliceExtractor> mergeTreeSliceExtractor(0, optionEnsembleSize.as<unsigned int>());
+		pipeline::Process<FeatureExtractor>        featureExtractor;
+
+		pipeline::Value<Image> image = rawImageReader->getOutput();
+		unsigned int width  = image->width();
+		unsigned int height = image->height();
+
+		mergeTreeSliceExtractor->setInput("boundaries", probabilityImageReader->getOutput());
+
+		// for an ensemble of merge trees, collect the slices of all trees
+		boost::shared_ptr<pipeline::ProcessNode> sliceExtractor;
+
+		if (optionEnsembleSize) {
+
+			sliceExtractor = boost::make_shared<SlicesCollector>();
+
+			for (unsigned int i = 0; i < optionEnsembleSize.as<unsigned int>(); i++) {
+
+				std::string suffix = " " + boost::lexical_cast<std::string>(i);
+
+				sliceExtractor->addInput("slices", mergeTreeSliceExtractor->getOutput("slices" + suffix));
+				sliceExtractor->addInput("conflict sets", mergeTreeSliceExtractor->getOutput("conflict sets" + suffix));
+			}
+
+		} else {
+
+			sliceExtractor = mergeTreeSliceExtractor.getOperator();
+		}
+
+		featureExtractor->setInput("slices", sliceExtractor->getOutput("slices"));
+		featureExtractor->setInput("raw image", rawImageReader->getOutput());
+		featureExtractor->setInput("probability image", probabilityImageReader->getOutput());
+
+		/**********************
+		 * INFERENCE PIPELINE *
+		 **********************/
+
+		pipeline::Process<FeatureWeightsReader>    featureWeightsReader;
+		pipeline::Process<LinearSliceCostFunction> sliceCostFunction;
+		pipeline::Process<ProblemAssembler>        problemAssembler;
+		pipeline::Process<LinearSolver>            linearSolver;
+		pipeline::Process<Reconstructor>           reconstructor;
+		pipeline::Process<SolutionWriter>          solutionWriter(width, height, optionSolutionImage.as<std::string>());
+
+		sliceCostFunction->setInput("slices", sliceExtractor->getOutput("slices"));
+		sliceCostFunction->setInput("features", featureExtractor->getOutput());
+		sliceCostFunction->setInput("feature weights", featureWeightsReader->getOutput());
+
+		problemAssembler->setInput("slices", sliceExtractor->getOutput("slices"));
+		problemAssembler->setInput("conflict sets", sliceExtractor->getOutput("conflict sets"));
+		problemAssembler->setInput("slice costs", sliceCostFunction->getOutput());
+
+		pipeline::Value<LinearSolverParameters> linearSolverParameters;
+		linearSolverParameters->setVariableType(Binary);
+		linearSolver->setInput("objective", problemAssembler->getOutput("objective"));
+		linearSolver->setInput("linear constraints", problemAssembler->getOutput("linear constraints"));
+		linearSolver->setInput("parameters", linearSolverParameters);
+
+		reconstructor->setInput("slices", sliceExtractor->getOutput("slices"));
+		reconstructor->setInput("slice variable map", problemAssembler->getOutput("slice variable map"));
+		reconstructor->setInput("solution", linearSolver->getOutput("solution"));
+
+		// prepare the output image directory
+		boost::filesystem::path directory = boost::filesystem::path(optionSolutionImage.as<std::string>()).parent_path();
+		if (!directory.empty() && !boost::filesystem::exists(directory))
+			boost::filesystem::create_directories(directory);
+
+		solutionWriter->setInput("solution", reconstructor->getOutput());
+		solutionWriter->write();
+
+	} catch (Exception& e) {
+
+		handleException(e, std::cerr);
+	}
+}
@@ -34,7 +34,7 @@ Distance::operator()(
 
 	// ...only non-zero if we want to align both slices
 	if (align)
-		offset2 = slice1.getComponent()->getCenter() - slice2.getComponent()->getCenter();
+		offset2 = slice1.getCenter() - slice2.getCenter();
 
 	distance(slice1, slice2, offset2, avgSliceDistance, maxSliceDistance);
 
@@ -70,13 +70,13 @@ Distance::operator()(
 
 		// the mean pixel location of slice1a and slice1b
 		util::point<double> center1 = 
-				(slice1a.getComponent()->getCenter()*slice1a.getComponent()->getSize()
+				(slice1a.getCenter()*slice1a.getSize()
 				 +
-				 slice1b.getComponent()->getCenter()*slice1b.getComponent()->getSize())
+				 slice1b.getCenter()*slice1b.getSize())
 				/
-				(double)(slice1a.getComponent()->getSize() + slice1b.getComponent()->getSize());
+				(double)(slice1a.getSize() + slice1b.getSize());
 
-		offset2 = center1 - slice2.getComponent()->getCenter();
+		offset2 = center1 - slice2.getCenter();
 	}
 
 	double avgSliceDistancea, avgSliceDistanceb;
@@ -86,9 +86,9 @@ Distance::operator()(
 	distance(slice1b, slice2, offset2, avgSliceDistanceb, maxSliceDistanceb);
 
 	avgSliceDistance =
-			(avgSliceDistancea*slice1a.getComponent()->getSize() +
-			 avgSliceDistanceb*slice1b.getComponent()->getSize())/
-			(slice1a.getComponent()->getSize() + slice1b.getComponent()->getSize());
+			(avgSliceDistancea*slice1a.getSize() +
+			 avgSliceDistanceb*slice1b.getSize())/
+			(slice1a.getSize() + slice1b.getSize());
 
 	maxSliceDistance = std::max(maxSliceDistancea, maxSliceDistanceb);
 
@@ -114,7 +114,9 @@ Distance::distance(
 		double& avgSliceDistance,
 		double& maxSliceDistance) {
 
-	const ConnectedComponent& c1 = *s1.getComponent();
+	// keep the blob alive, it might have been created for this call
+	boost::shared_ptr<ConnectedComponent> component1 = s1.getComponent();
+	const ConnectedComponent& c1 = *component1;
 
 	const util::rect<int> s2dmbb = getDistanceMapBoundingBox(s2);
 
@@ -144,7 +146,7 @@ Distance::distance(
 		maxSliceDistance = std::max(maxSliceDistance, dist);
 	}
 
-	avgSliceDistance = totalDistance/s1.getComponent()->getSize();
+	avgSliceDistance = totalDistance/s1.getSize();
 }
 
 void
@@ -156,7 +158,9 @@ Distance::distance(
 		double& avgSliceDistance,
 		double& maxSliceDistance) {
 
-	const ConnectedComponent& c1 = *s1.getComponent();
+	// keep the blob alive, it might have been created for this call
+	boost::shared_ptr<ConnectedComponent> component1 = s1.getComponent();
+	const ConnectedComponent& c1 = *component1;
 
 	const util::rect<int> s2dmbba = getDistanceMapBoundingBox(s2a);
 	const util::rect<int> s2dmbbb = getDistanceMapBoundingBox(s2b);
@@ -216,14 +220,14 @@ Distance::distance(
 		maxSliceDistance = std::max(maxSliceDistance, dist);
 	}
 
-	avgSliceDistance = totalDistance/s1.getComponent()->getSize();
+	avgSliceDistance = totalDistance/s1.getSize();
 }
 
 util::rect<int>
 Distance::getDistanceMapBoundingBox(const Slice& slice) {
 
 
-	const util::rect<int>& boundingBox = slice.getComponent()->getBoundingBox();
+	const util::rect<int>& boundingBox = slice.getBoundingBox();
 
 	// comput size and offset of distance map
 	util::rect<int> distanceMapBoundingBox;
@@ -247,7 +251,7 @@ Distance::getDistanceMap(const Slice& slice) {
 Distance::distance_map_type
 Distance::computeDistanceMap(const Slice& slice) {
 
-	const util::rect<int>& boundingBox = slice.getComponent()->getBoundingBox();
+	const util::rect<int>& boundingBox = slice.getBoundingBox();
 
 	// comput size and offset of distance map
 	util::rect<int> distanceMapBoundingBox = getDistanceMapBoundingBox(slice);
@@ -258,7 +262,8 @@ Distance::computeDistanceMap(const Slice& slice) {
 	distance_map_type objectImage(shape, 0.0);
 
 	// copy slice pixels into object image
-	foreach (const util::point<unsigned int>& pixel, slice.getComponent()->getPixels()) {
+	boost::shared_ptr<ConnectedComponent> component = slice.getComponent();
+	foreach (const util::point<unsigned int>& pixel, component->getPixels()) {
 
 		int x = pixel.x - boundingBox.minX + _maxDistance;
 		int y = pixel.y - boundingBox.minY + _maxDistance;
@@ -5,6 +5,7 @@
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include <util/helpers.hpp>
+#include <parallel/ParallelFor.h>
 #include "FeatureExtractor.h"
 
 logger::LogChannel featureextractorlog("featureextractorlog", "[FeatureExtractor] ");
@@ -119,83 +120,22 @@ FeatureExtractor::updateOutputs() {
 	// REGION FEATURES //
 	/////////////////////
 
-	foreach (boost::shared_ptr<Slice> slice, *_slices) {
-		// the bounding box of the slice in the raw image
-		const util::rect<unsigned int>& sliceBoundingBox = slice->getComponent()->getBoundingBox();
-
-		LOG_DEBUG(featureextractorlog) << "extracting features for slice " << slice->getId() << std::endl;
-		LOG_ALL(featureextractorlog) << "slice bounding box: " << sliceBoundingBox << std::endl;
-		foreach (const util::point<unsigned int>& p, slice->getComponent()->getPixels())
-			LOG_ALL(featureextractorlog) << "  " << p << std::endl;
-
-		// a view to the raw image for the slice bounding box
-		typedef vigra::MultiArrayView<2, float>::difference_type Shape;
-		vigra::MultiArrayView<2, float> rawSliceImage =
-				_rawImage->subarray(
-						Shape(sliceBoundingBox.minX, sliceBoundingBox.minY),
-						Shape(sliceBoundingBox.maxX, sliceBoundingBox.maxY));
-
-		// the "label" image
-		vigra::MultiArrayView<2, bool> labelImage = slice->getComponent()->getBitmap();
-
-		// an adaptor to access the feature map with the right id
-		FeatureIdAdaptor adaptor(slice->getId(), *_features);
-
-		RegionFeatures<2, float, bool>::Parameters p;
-		p.computeRegionprops = optionShapeFeatures;
-		if (optionNoCoordinatesStatistics)
-			p.statisticsParameters.computeCoordinateStatistics = false;
-		p.regionpropsParameters.numAnglePoints = optionFeaturePointinessAnglePoints;
-		p.regionpropsParameters.contourVecAsArcSegmentRatio = optionFeaturePointinessVectorLength;
-		p.regionpropsParameters.numAngleHistBins = optionFeaturePointinessHistogramBins;
-		RegionFeatures<2, float, bool> regionFeatures(rawSliceImage, labelImage, p);
-
-		regionFeatures.fill(adaptor);
-
-		if (optionProbabilityImageFeatures) {
-
-			vigra::MultiArrayView<2, float> probabilitySliceImage =
-					_probabilityImage->subarray(
-							Shape(sliceBoundingBox.minX, sliceBoundingBox.minY),
-							Shape(sliceBoundingBox.maxX, sliceBoundingBox.maxY));
-			RegionFeatures<2, float, bool>::Parameters probParams;
-			if (optionNoCoordinatesStatistics)
-				probParams.statisticsParameters.computeCoordinateStatistics = false;
-			RegionFeatures<2, float, bool> probRegionFeatures(probabilitySliceImage, labelImage, probParams);
-			probRegionFeatures.fill(adaptor);
-
-			if (optionProbabilityImageBoundaryFeatures) {
-
-				// create the boundary image
-				vigra::MultiArray<2, bool> erosionImage(labelImage.shape());
-				vigra::discErosion(labelImage, erosionImage, 1);
-				vigra::MultiArray<2, bool> boundaryImage(labelImage.shape());
-				boundaryImage = labelImage;
-				boundaryImage -= erosionImage;
-
-				unsigned int width  = boundaryImage.width();
-				unsigned int height = boundaryImage.height();
-
-				for (unsigned int x = 0; x < width; x++) {
+	// the feature rows of all slices, which stay in place from here on
+	std::vector<std::vector<double>*> rows;
+	rows.reserve(_slices->size());
+	foreach (boost::shared_ptr<Slice> slice, *_slices)
+		rows.push_back(&_features->getFeatures(slice->getId()));
 
-					boundaryImage(x, 0)		|= labelImage(x, 0);
-					boundaryImage(x, height-1) |= labelImage(x, height-1);
-				}
+	// bitmaps might be created lazily, make sure this does not happen 
+	// concurrently
+	foreach (boost::shared_ptr<Slice> slice, *_slices)
+		if (!slice->hasSpans())
+			slice->getComponent()->getBitmap();
 
-				for (unsigned int y = 1; y < height-1; y++) {
-
-					boundaryImage(0, y)	   |= labelImage(0, y);
-					boundaryImage(width-1, y) |= labelImage(width-1, y);
-				}
-
-				RegionFeatures<2, float, bool>::Parameters boundaryParams;
-				if (optionNoCoordinatesStatistics)
-					boundaryParams.statisticsParameters.computeCoordinateStatistics = false;
-				RegionFeatures<2, float, bool> boundaryFeatures(probabilitySliceImage, boundaryImage, boundaryParams);
-				boundaryFeatures.fill(adaptor);
-			}
-		}
-	}
+	parallel::parallelFor(
+			0, _slices->size(),
+			RegionFeatureExtraction(*_slices, *_rawImage, *_probabilityImage, rows),
+			16);
 
 	LOG_USER(featureextractorlog)
 			<< "extracted "
@@ -313,3 +253,105 @@ FeatureExtractor::updateOutputs() {
 
 	LOG_USER(featureextractorlog) << "done" << std::endl;
 }
+
+FeatureExtractor::RegionFeatureExtraction::RegionFeatureExtraction(
+		const Slices&                            slices,
+		const Image&                             rawImage,
+		const Image&                             probabilityImage,
+		const std::vector<std::vector<double>*>& rows) :
+	_slices(slices),
+	_rawImage(rawImage),
+	_probabilityImage(probabilityImage),
+	_rows(rows),
+	_shapeFeatures(optionShapeFeatures),
+	_probabilityImageFeatures(optionProbabilityImageFeatures),
+	_probabilityImageBoundaryFeatures(optionProbabilityImageBoundaryFeatures),
+	_noCoordinatesStatistics(optionNoCoordinatesStatistics),
+	_numAnglePoints(optionFeaturePointinessAnglePoints),
+	_angleVectorLength(optionFeaturePointinessVectorLength),
+	_numHistogramBins(optionFeaturePointinessHistogramBins) {}
+
+void
+FeatureExtractor::RegionFeatureExtraction::operator()(unsigned int i) const {
+
+	boost::shared_ptr<Slice> slice = _slices[i];
+
+	// the blob of the slice, created here for run-length encoded slices
+	boost::shared_ptr<ConnectedComponent> component = slice->getComponent();
+
+	// the bounding box of the slice in the raw image
+	const util::rect<unsigned int>& sliceBoundingBox = component->getBoundingBox();
+
+	LOG_DEBUG(featureextractorlog) << "extracting features for slice " << slice->getId() << std::endl;
+	LOG_ALL(featureextractorlog) << "slice bounding box: " << sliceBoundingBox << std::endl;
+	foreach (const util::point<unsigned int>& p, component->getPixels())
+		LOG_ALL(featureextractorlog) << "  " << p << std::endl;
+
+	// a view to the raw image for the slice bounding box
+	typedef vigra::MultiArrayView<2, float>::difference_type Shape;
+	vigra::MultiArrayView<2, float> rawSliceImage =
+			_rawImage.subarray(
+					Shape(sliceBoundingBox.minX, sliceBoundingBox.minY),
+					Shape(sliceBoundingBox.maxX, sliceBoundingBox.maxY));
+
+	// the "label" image
+	vigra::MultiArrayView<2, bool> labelImage = component->getBitmap();
+
+	// an adaptor to access the feature row of the slice
+	FeatureIdAdaptor adaptor(*_rows[i]);
+
+	RegionFeatures<2, float, bool>::Parameters p;
+	p.computeRegionprops = _shapeFeatures;
+	if (_noCoordinatesStatistics)
+		p.statisticsParameters.computeCoordinateStatistics = false;
+	p.regionpropsParameters.numAnglePoints = _numAnglePoints;
+	p.regionpropsParameters.contourVecAsArcSegmentRatio = _angleVectorLength;
+	p.regionpropsParameters.numAngleHistBins = _numHistogramBins;
+	RegionFeatures<2, float, bool> regionFeatures(rawSliceImage, labelImage, p);
+
+	regionFeatures.fill(adaptor);
+
+	if (_probabilityImageFeatures) {
+
+		vigra::MultiArrayView<2, float> probabilitySliceImage =
+				_probabilityImage.subarray(
+						Shape(sliceBoundingBox.minX, sliceBoundingBox.minY),
+						Shape(sliceBoundingBox.maxX, sliceBoundingBox.maxY));
+		RegionFeatures<2, float, bool>::Parameters probParams;
+		if (_noCoordinatesStatistics)
+			probParams.statisticsParameters.computeCoordinateStatistics = false;
+		RegionFeatures<2, float, bool> probRegionFeatures(probabilitySliceImage, labelImage, probParams);
+		probRegionFeatures.fill(adaptor);
+
+		if (_probabilityImageBoundaryFeatures) {
+
+			// create the boundary image
+			vigra::MultiArray<2, bool> erosionImage(labelImage.shape());
+			vigra::discErosion(labelImage, erosionImage, 1);
+			vigra::MultiArray<2, bool> boundaryImage(labelImage.shape());
+			boundaryImage = labelImage;
+			boundaryImage -= erosionImage;
+
+			unsigned int width  = boundaryImage.width();
+			unsigned int height = boundaryImage.height();
+
+			for (unsigned int x = 0; x < width; x++) {
+
+				boundaryImage(x, 0)		|= labelImage(x, 0);
+				boundaryImage(x, height-1) |= labelImage(x, height-1);
+			}
+
+			for (unsigned int y = 1; y < height-1; y++) {
+
+				boundaryImage(0, y)	   |= labelImage(0, y);
+				boundaryImage(width-1, y) |= labelImage(width-1, y);
+			}
+
+			RegionFeatures<2, float, bool>::Parameters boundaryParams;
+			if (_noCoordinatesStatistics)
+				boundaryParams.statisticsParameters.computeCoordinateStatistics = false;
+			RegionFeatures<2, float, bool> boundaryFeatures(probabilitySliceImage, boundaryImage, boundaryParams);
+			boundaryFeatures.fill(adaptor);
+		}
+	}
+}
@@ -1,6 +1,7 @@
 #ifndef MULTI2CUT_FEATURES_FEATURE_EXTRACTOR_H__
 #define MULTI2CUT_FEATURES_FEATURE_EXTRACTOR_H__
 
+#include <vector>
 #include <pipeline/SimpleProcessNode.h>
 #include <slices/Slices.h>
 #include "Features.h"
@@ -15,19 +16,58 @@ private:
 
 	/**
 	 * Adaptor to be used with RegionFeatures, such that mapping to the correct 
-	 * slice id is preserved.
+	 * slice is preserved. Appends to the preallocated feature row of a single 
+	 * slice, such that adaptors of different slices can be used concurrently.
 	 */
 	class FeatureIdAdaptor {
 
 	public:
-		FeatureIdAdaptor(unsigned int id, Features& features) : _id(id), _features(features) {}
+		FeatureIdAdaptor(std::vector<double>& features) : _features(features) {}
 
-		inline void append(unsigned int /*ignored*/, double value) { _features.append(_id, value); }
+		inline void append(unsigned int /*ignored*/, double value) {
+
+			// nan -> 0, as in Features::append()
+			if (value != value)
+				value = 0;
+
+			_features.push_back(value);
+		}
+
+	private:
+
+		std::vector<double>& _features;
+	};
+
+	/**
+	 * Extracts the region features of the i-th slice into its feature row.
+	 */
+	class RegionFeatureExtraction {
+
+	public:
+
+		RegionFeatureExtraction(
+				const Slices&                            slices,
+				const Image&                             rawImage,
+				const Image&                             probabilityImage,
+				const std::vector<std::vector<double>*>& rows);
+
+		void operator()(unsigned int i) const;
 
 	private:
 
-		unsigned int _id;
-		Features&    _features;
+		const Slices&                            _slices;
+		const Image&                             _rawImage;
+		const Image&                             _probabilityImage;
+		const std::vector<std::vector<double>*>& _rows;
+
+		// the program options, read once before the threads start
+		bool         _shapeFeatures;
+		bool         _probabilityImageFeatures;
+		bool         _probabilityImageBoundaryFeatures;
+		bool         _noCoordinatesStatistics;
+		unsigned int _numAnglePoints;
+		double       _angleVectorLength;
+		unsigned int _numHistogramBins;
 	};
 
 	void updateOutputs();
@@ -3,12 +3,13 @@
 
 #include <pipeline/Data.h>
 #include <util/exceptions.h>
+#include <slices/SliceIdMap.h>
 
 class Features : public pipeline::Data {
 
 public:
 
-	typedef std::map<unsigned int, std::vector<double> > features_type;
+	typedef SliceIdMap<std::vector<double> > features_type;
 
 	Features() {}
 
@@ -70,10 +71,12 @@ public:
 		if (_features.size() == 0)
 			return;
 
-		if (min.size() != _features.begin()->second.size())
+		const std::vector<double>& first = _features.at(_features.begin().id());
+
+		if (min.size() != first.size())
 			UTIL_THROW_EXCEPTION(
 					UsageError,
-					"provided min and max have different size " << min.size() << " than features " << _features.begin()->second.size());
+					"provided min and max have different size " << min.size() << " than features " << first.size());
 
 		normalizeMinMax(min, max);
 	}
@@ -107,10 +110,9 @@ private:
 		_min.clear();
 		_max.clear();
 
-		typedef std::map<unsigned int, std::vector<double> >::value_type pair_t;
-		foreach (pair_t& pair, _features) {
+		for (features_type::const_iterator i = _features.begin(); i != _features.end(); ++i) {
 
-			const std::vector<double>& features = pair.second;
+			const std::vector<double>& features = _features.at(i.id());
 
 			if (_min.size() == 0) {
 
@@ -130,10 +132,9 @@ private:
 
 	void normalizeMinMax(const std::vector<double>& min, const std::vector<double>& max) {
 
-		typedef std::map<unsigned int, std::vector<double> >::value_type pair_t;
-		foreach (pair_t& pair, _features) {
+		for (features_type::const_iterator i = _features.begin(); i != _features.end(); ++i) {
 
-			std::vector<double>& features = pair.second;
+			std::vector<double>& features = _features.at(i.id());
 
 			if (features.size() != min.size())
 				UTIL_THROW_EXCEPTION(
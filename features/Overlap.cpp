@@ -11,11 +11,11 @@ Overlap::operator()(const Slice& slice1, const Slice& slice2) {
 
 	// ...only non-zero if we want to align both slices
 	if (_align)
-		offset2 = slice1.getComponent()->getCenter() - slice2.getComponent()->getCenter();
+		offset2 = slice1.getCenter() - slice2.getCenter();
 
 	unsigned int numOverlap = overlap(
-			*slice1.getComponent(),
-			*slice2.getComponent(),
+			slice1,
+			slice2,
 			offset2);
 
 	if (_normalized) {
@@ -39,22 +39,22 @@ Overlap::operator()(const Slice& slice1a, const Slice& slice1b, const Slice& sli
 
 		// the mean pixel location of slice1a and slice1b
 		util::point<double> center1 = 
-				(slice1a.getComponent()->getCenter()*slice1a.getComponent()->getSize()
+				(slice1a.getCenter()*slice1a.getSize()
 				 +
-				 slice1b.getComponent()->getCenter()*slice1b.getComponent()->getSize())
+				 slice1b.getCenter()*slice1b.getSize())
 				/
-				(double)(slice1a.getComponent()->getSize() + slice1b.getComponent()->getSize());
+				(double)(slice1a.getSize() + slice1b.getSize());
 
-		offset2 = center1 - slice2.getComponent()->getCenter();
+		offset2 = center1 - slice2.getCenter();
 	}
 
 	unsigned int numOverlapa = overlap(
-			*slice1a.getComponent(),
-			*slice2.getComponent(),
+			slice1a,
+			slice2,
 			offset2);
 	unsigned int numOverlapb = overlap(
-			*slice1b.getComponent(),
-			*slice2.getComponent(),
+			slice1b,
+			slice2,
 			offset2);
 
 	unsigned int numOverlap = numOverlapa + numOverlapb;
@@ -89,9 +89,9 @@ Overlap::exceeds(const Slice& slice1, const Slice& slice2, double value, double&
 
 	// ...only non-zero if we want to align both slices
 	if (_align)
-		offset2 = slice1.getComponent()->getCenter() - slice2.getComponent()->getCenter();
+		offset2 = slice1.getCenter() - slice2.getCenter();
 
-	util::rect<double> bb_intersection = slice1.getComponent()->getBoundingBox().intersection(slice2.getComponent()->getBoundingBox() + offset2);
+	util::rect<double> bb_intersection = slice1.getBoundingBox().intersection(slice2.getBoundingBox() + offset2);
 
 	double maxOverlap = bb_intersection.area();
 
@@ -130,17 +130,17 @@ Overlap::exceeds(const Slice& slice1a, const Slice& slice1b, const Slice& slice2
 
 		// the mean pixel location of slice1a and slice1b
 		util::point<double> center1 = 
-				(slice1a.getComponent()->getCenter()*slice1a.getComponent()->getSize()
+				(slice1a.getCenter()*slice1a.getSize()
 				 +
-				 slice1b.getComponent()->getCenter()*slice1b.getComponent()->getSize())
+				 slice1b.getCenter()*slice1b.getSize())
 				/
-				(double)(slice1a.getComponent()->getSize() + slice1b.getComponent()->getSize());
+				(double)(slice1a.getSize() + slice1b.getSize());
 
-		offset2 = center1 - slice2.getComponent()->getCenter();
+		offset2 = center1 - slice2.getCenter();
 	}
 
-	util::rect<double> bb_intersection_a = slice1a.getComponent()->getBoundingBox().intersection(slice2.getComponent()->getBoundingBox() + offset2);
-	util::rect<double> bb_intersection_b = slice1b.getComponent()->getBoundingBox().intersection(slice2.getComponent()->getBoundingBox() + offset2);
+	util::rect<double> bb_intersection_a = slice1a.getBoundingBox().intersection(slice2.getBoundingBox() + offset2);
+	util::rect<double> bb_intersection_b = slice1b.getBoundingBox().intersection(slice2.getBoundingBox() + offset2);
 
 	double maxOverlap = bb_intersection_a.area() + bb_intersection_b.area();
 
@@ -160,10 +160,20 @@ Overlap::exceeds(const Slice& slice1a, const Slice& slice1b, const Slice& slice2
 
 unsigned int
 Overlap::overlap(
-		const ConnectedComponent& c1,
-		const ConnectedComponent& c2,
+		const Slice& slice1,
+		const Slice& slice2,
 		const util::point<int>& offset2) {
 
+	if (slice1.hasSpans() && slice2.hasSpans())
+		return slice1.getSpans().intersectionSize(slice2.getSpans(), offset2);
+
+	// keep the blobs alive, they might have been created for this call
+	boost::shared_ptr<ConnectedComponent> component1 = slice1.getComponent();
+	boost::shared_ptr<ConnectedComponent> component2 = slice2.getComponent();
+
+	const ConnectedComponent& c1 = *component1;
+	const ConnectedComponent& c2 = *component2;
+
 	if (!c1.getBoundingBox().intersects(c2.getBoundingBox() + offset2))
 		return 0;
 
@@ -201,7 +211,7 @@ Overlap::overlap(
 double
 Overlap::normalize(const Slice& slice1, const Slice& slice2, unsigned int overlap) {
 
-	int totalSize = slice1.getComponent()->getSize() + slice2.getComponent()->getSize() - overlap;
+	int totalSize = slice1.getSize() + slice2.getSize() - overlap;
 
 	if (totalSize <= 0)
 		totalSize = 1;
@@ -212,7 +222,7 @@ Overlap::normalize(const Slice& slice1, const Slice& slice2, unsigned int overla
 double
 Overlap::normalize(const Slice& slice1a, const Slice& slice1b, const Slice& slice2, unsigned int overlap) {
 
-	int totalSize = slice1a.getComponent()->getSize() + slice1b.getComponent()->getSize() + slice2.getComponent()->getSize() - overlap;
+	int totalSize = slice1a.getSize() + slice1b.getSize() + slice2.getSize() - overlap;
 
 	if (totalSize <= 0)
 		totalSize = 1;
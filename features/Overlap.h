@@ -5,7 +5,6 @@
 
 // forward declarations
 class Slice;
-class ConnectedComponent;
 
 struct Overlap {
 
@@ -100,8 +99,8 @@ struct Overlap {
 private:
 
 	unsigned int overlap(
-			const ConnectedComponent& c1,
-			const ConnectedComponent& c2,
+			const Slice& slice1,
+			const Slice& slice2,
 			const util::point<int>& offset2);
 
 	bool _normalized;
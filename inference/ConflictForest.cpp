@@ -0,0 +1,167 @@
+#include <limits>
+
+#include <util/foreach.h>
+#include "ConflictForest.h"
+
+const unsigned int ConflictForest::NoParent = std::numeric_limits<unsigned int>::max();
+
+ConflictForest::ConflictForest(unsigned int numVariables) {
+
+	reset(numVariables);
+}
+
+void
+ConflictForest::reset(unsigned int numVariables) {
+
+	_parents.assign(numVariables, NoParent);
+	_isRoot.assign(numVariables, false);
+}
+
+bool
+ConflictForest::isAtMostOneConstraint(const LinearConstraint& constraint) {
+
+	if (constraint.getRelation() != LessEqual || constraint.getValue() != 1.0)
+		return false;
+
+	unsigned int varNum;
+	double coef;
+	foreach (boost::tie(varNum, coef), constraint.getCoefficients())
+		if (coef != 1.0)
+			return false;
+
+	return true;
+}
+
+bool
+ConflictForest::addPath(const LinearConstraint& constraint) {
+
+	const std::map<unsigned int, double>& coefs = constraint.getCoefficients();
+
+	if (coefs.empty())
+		return true;
+
+	// the coefficients are sorted by variable number, which is the order of
+	// the variables from the root to the leaf
+
+	std::map<unsigned int, double>::const_iterator i = coefs.begin();
+
+	if (i->first >= _parents.size())
+		return false;
+
+	// the first variable has to be a root
+	if (_parents[i->first] != NoParent)
+		return false;
+
+	unsigned int prev = i->first;
+	for (++i; i != coefs.end(); ++i) {
+
+		unsigned int varNum = i->first;
+
+		if (varNum >= _parents.size() || _isRoot[varNum])
+			return false;
+
+		if (_parents[varNum] != NoParent && _parents[varNum] != prev)
+			return false;
+
+		prev = varNum;
+	}
+
+	// the path is consistent, add it
+
+	i = coefs.begin();
+	_isRoot[i->first] = true;
+
+	prev = i->first;
+	for (++i; i != coefs.end(); ++i) {
+
+		_parents[i->first] = prev;
+		prev = i->first;
+	}
+
+	return true;
+}
+
+double
+ConflictForest::solve(const std::vector<double>& costs, std::vector<double>& solution) const {
+
+	unsigned int numVariables = _parents.size();
+
+	std::vector<unsigned int> all(numVariables);
+	for (unsigned int v = 0; v < numVariables; v++)
+		all[v] = v;
+
+	std::vector<double> childrenValue(numVariables);
+	std::vector<char>   excluded(numVariables);
+	solution.resize(numVariables);
+
+	return solveTree(all, costs, solution, childrenValue, excluded);
+}
+
+std::vector<std::vector<unsigned int> >
+ConflictForest::getTrees() const {
+
+	unsigned int numVariables = _parents.size();
+
+	std::vector<std::vector<unsigned int> > trees;
+
+	// the tree of each variable, parents are visited before their children
+	std::vector<unsigned int> treeOf(numVariables);
+
+	for (unsigned int v = 0; v < numVariables; v++) {
+
+		if (_parents[v] == NoParent) {
+
+			treeOf[v] = trees.size();
+			trees.push_back(std::vector<unsigned int>());
+
+		} else {
+
+			treeOf[v] = treeOf[_parents[v]];
+		}
+
+		trees[treeOf[v]].push_back(v);
+	}
+
+	return trees;
+}
+
+double
+ConflictForest::solveTree(
+		const std::vector<unsigned int>& tree,
+		const std::vector<double>&       costs,
+		std::vector<double>&             solution,
+		std::vector<double>&             childrenValue,
+		std::vector<char>&               excluded) const {
+
+	foreach (unsigned int v, tree)
+		childrenValue[v] = 0.0;
+
+	double value = 0;
+
+	// children have larger variable numbers than their parents, a backwards
+	// sweep visits all children before their parents
+	for (std::vector<unsigned int>::const_reverse_iterator i = tree.rbegin(); i != tree.rend(); i++) {
+
+		unsigned int v = *i;
+
+		double best = std::min(costs[v], childrenValue[v]);
+
+		if (_parents[v] == NoParent)
+			value += best;
+		else
+			childrenValue[_parents[v]] += best;
+	}
+
+	// select top-down: a variable is chosen if it is not excluded by a chosen
+	// ancestor and not worse than the best choice of its descendants
+	foreach (unsigned int v, tree) {
+
+		unsigned int parent = _parents[v];
+
+		excluded[v] = (parent != NoParent && (excluded[parent] || solution[parent] == 1.0));
+
+		solution[v] = (!excluded[v] && costs[v] <= childrenValue[v] ? 1.0 : 0.0);
+	}
+
+	return value;
+}
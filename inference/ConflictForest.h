@@ -0,0 +1,117 @@
+#ifndef INFERENCE_CONFLICT_FOREST_H__
+#define INFERENCE_CONFLICT_FOREST_H__
+
+#include <vector>
+
+#include "LinearConstraint.h"
+
+/**
+ * A forest over binary variables, reconstructed from "at most one of"
+ * constraints that each cover a path from a root to a node. For a single merge
+ * tree, ComponentTreeConverter creates exactly such constraints (one per leaf)
+ * and assigns increasing variable numbers from the root to the leafs. Within a
+ * path, the variable with the smallest number is therefore the root, and each
+ * following variable is a child of its predecessor.
+ *
+ * If all constraints of a problem can be added to the forest, the problem
+ * "minimize <c,x> such that at most one variable per path is one" is solved
+ * exactly by a single bottom-up pass over the forest.
+ */
+class ConflictForest {
+
+public:
+
+	/**
+	 * Create an empty forest, in which every variable is an isolated root.
+	 */
+	ConflictForest(unsigned int numVariables = 0);
+
+	/**
+	 * Remove all edges and reset the forest to the given number of variables.
+	 */
+	void reset(unsigned int numVariables);
+
+	/**
+	 * Test whether a linear constraint is of the form "sum of some variables
+	 * <= 1" with unit coefficients.
+	 */
+	static bool isAtMostOneConstraint(const LinearConstraint& constraint);
+
+	/**
+	 * Add the path of an at-most-one constraint to the forest. The constraint
+	 * is only added if it is consistent with the paths added so far, i.e., if
+	 * its smallest variable is a root and each other variable is either not
+	 * connected yet or already a child of its predecessor.
+	 *
+	 * @return true, if the constraint was added. In this case, the forest
+	 *         contains a root-to-leaf path for the constraint. Otherwise, the
+	 *         forest remains unchanged.
+	 */
+	bool addPath(const LinearConstraint& constraint);
+
+	/**
+	 * Get the number of variables in the forest.
+	 */
+	unsigned int size() const { return _parents.size(); }
+
+	/**
+	 * Get the parent of a variable, or NoParent for roots.
+	 */
+	unsigned int getParent(unsigned int varNum) const { return _parents[varNum]; }
+
+	/**
+	 * Find the minimal solution of <costs,x> such that at most one variable
+	 * on each root-to-leaf path is set to one.
+	 *
+	 * @param costs
+	 *             The costs for each variable.
+	 * @param solution
+	 *             The optimal assignment (0 or 1) for each variable.
+	 * @return The minimal value of <costs,x>.
+	 */
+	double solve(const std::vector<double>& costs, std::vector<double>& solution) const;
+
+	/**
+	 * Get the trees of the forest. Each tree is given as the list of its
+	 * variables in increasing order.
+	 */
+	std::vector<std::vector<unsigned int> > getTrees() const;
+
+	/**
+	 * Same as solve(), but only for the variables of a single tree (as
+	 * returned by getTrees()). Only the entries of the given tree are written
+	 * in solution and the scratch vectors, such that different trees can be
+	 * solved concurrently.
+	 *
+	 * @param tree
+	 *             The variables of the tree in increasing order.
+	 * @param costs
+	 *             The costs for each variable.
+	 * @param solution
+	 *             The optimal assignment for each variable of the tree.
+	 * @param childrenValue
+	 *             Scratch space of size size().
+	 * @param excluded
+	 *             Scratch space of size size().
+	 * @return The minimal value of <costs,x> for the tree.
+	 */
+	double solveTree(
+			const std::vector<unsigned int>& tree,
+			const std::vector<double>&       costs,
+			std::vector<double>&             solution,
+			std::vector<double>&             childrenValue,
+			std::vector<char>&               excluded) const;
+
+	static const unsigned int NoParent;
+
+private:
+
+	// the parent of each variable, or NoParent for roots
+	std::vector<unsigned int> _parents;
+
+	// whether a variable has been used as the first variable of a path
+	std::vector<bool> _isRoot;
+};
+
+#endif // INFERENCE_CONFLICT_FOREST_H__
+
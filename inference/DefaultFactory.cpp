@@ -1,6 +1,10 @@
 #include "DefaultFactory.h"
 
 #include <config.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include "DualDecompositionBackend.h"
+#include "TreeSolverBackend.h"
 
 #ifdef HAVE_GUROBI
 #include "GurobiBackend.h"
@@ -10,9 +14,37 @@
 #include "CplexBackend.h"
 #endif
 
+util::ProgramOption optionLinearSolver(
+		util::_module           = "inference",
+		util::_long_name        = "linearSolver",
+		util::_description_text = "The linear solver to use. Valid values are: 'auto' (default, solves single merge-tree "
+		                          "problems exactly by dynamic programming and falls back to an ILP solver otherwise), "
+		                          "'dualdecomposition' (solves problems of several merge trees by Lagrangian relaxation of "
+		                          "the conflicts between trees), and 'ilp' (always use Gurobi or CPLEX).",
+		util::_default_value    = "auto");
+
 LinearSolverBackend*
 DefaultFactory::createLinearSolverBackend() const {
 
+	std::string solver = optionLinearSolver.as<std::string>();
+
+	if (solver == "auto")
+		return new TreeSolverBackend();
+
+	if (solver == "dualdecomposition")
+		return new DualDecompositionBackend();
+
+	if (solver == "ilp")
+		return createIlpSolverBackend();
+
+	UTIL_THROW_EXCEPTION(
+			UsageError,
+			"unknown linear solver '" << solver << "'");
+}
+
+LinearSolverBackend*
+DefaultFactory::createIlpSolverBackend() const {
+
 // by default, create a gurobi backend
 #ifdef HAVE_GUROBI
 
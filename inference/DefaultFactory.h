@@ -13,8 +13,21 @@ class DefaultFactory :
 
 public:
 
+	/**
+	 * Create the linear solver backend selected by the program option
+	 * 'linearSolver'. By default, this is a TreeSolverBackend, which solves
+	 * single merge-tree problems exactly and uses an ILP solver otherwise.
+	 * For problems of several merge trees, a DualDecompositionBackend can be
+	 * selected.
+	 */
 	LinearSolverBackend* createLinearSolverBackend() const;
 
+	/**
+	 * Create a general ILP solver backend (Gurobi or CPLEX, whichever is
+	 * available).
+	 */
+	LinearSolverBackend* createIlpSolverBackend() const;
+
 	QuadraticSolverBackend* createQuadraticSolverBackend() const;
 };
 
@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include <parallel/ParallelFor.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/foreach.h>
+#include "DefaultFactory.h"
+#include "DualDecompositionBackend.h"
+
+logger::LogChannel dualdecompositionlog("dualdecompositionlog", "[DualDecompositionBackend] ");
+
+util::ProgramOption optionDualDecompositionMaxIterations(
+		util::_module           = "inference.dualdecomposition",
+		util::_long_name        = "maxIterations",
+		util::_description_text = "The maximal number of subgradient iterations.",
+		util::_default_value    = 200);
+
+util::ProgramOption optionDualDecompositionRelativeGap(
+		util::_module           = "inference.dualdecomposition",
+		util::_long_name        = "relativeGap",
+		util::_description_text = "Stop if the duality gap relative to the value of the best solution is smaller than this.",
+		util::_default_value    = 0.0001);
+
+util::ProgramOption optionDualDecompositionStepScale(
+		util::_module           = "inference.dualdecomposition",
+		util::_long_name        = "stepScale",
+		util::_description_text = "The initial scale of the Polyak step size. It is halved whenever the dual bound did not "
+		                          "improve for 10 iterations.",
+		util::_default_value    = 2.0);
+
+namespace {
+
+// solves a single tree of a ConflictForest
+class TreeSolver {
+
+public:
+
+	TreeSolver(
+			const ConflictForest&                          forest,
+			const std::vector<std::vector<unsigned int> >& trees,
+			const std::vector<double>&                     costs,
+			std::vector<double>&                           solution,
+			std::vector<double>&                           childrenValue,
+			std::vector<char>&                             excluded,
+			std::vector<double>&                           values) :
+		_forest(forest),
+		_trees(trees),
+		_costs(costs),
+		_solution(solution),
+		_childrenValue(childrenValue),
+		_excluded(excluded),
+		_values(values) {}
+
+	void operator()(unsigned int i) const {
+
+		_values[i] = _forest.solveTree(_trees[i], _costs, _solution, _childrenValue, _excluded);
+	}
+
+private:
+
+	const ConflictForest&                          _forest;
+	const std::vector<std::vector<unsigned int> >& _trees;
+	const std::vector<double>&                     _costs;
+	std::vector<double>&                           _solution;
+	std::vector<double>&                           _childrenValue;
+	std::vector<char>&                             _excluded;
+	std::vector<double>&                           _values;
+};
+
+// orders variables by increasing costs
+class CostsLess {
+
+public:
+
+	CostsLess(const std::vector<double>& costs) :
+		_costs(costs) {}
+
+	bool operator()(unsigned int a, unsigned int b) const {
+
+		if (_costs[a] == _costs[b])
+			return a < b;
+
+		return _costs[a] < _costs[b];
+	}
+
+private:
+
+	const std::vector<double>& _costs;
+};
+
+} // anonymous namespace
+
+DualDecompositionBackend::DualDecompositionBackend() :
+	_numVariables(0),
+	_defaultVariableType(Continuous),
+	_fallback(0) {}
+
+DualDecompositionBackend::~DualDecompositionBackend() {
+
+	if (_fallback)
+		delete _fallback;
+}
+
+void
+DualDecompositionBackend::initialize(
+		unsigned int numVariables,
+		VariableType variableType) {
+
+	initialize(numVariables, variableType, std::map<unsigned int, VariableType>());
+}
+
+void
+DualDecompositionBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes) {
+
+	_numVariables         = numVariables;
+	_defaultVariableType  = defaultVariableType;
+	_specialVariableTypes = specialVariableTypes;
+
+	if (_fallback)
+		_fallback->initialize(numVariables, defaultVariableType, specialVariableTypes);
+}
+
+void
+DualDecompositionBackend::setObjective(const LinearObjective& objective) {
+
+	_objective = objective;
+
+	if (_fallback)
+		_fallback->setObjective(objective);
+}
+
+void
+DualDecompositionBackend::setConstraints(const LinearConstraints& constraints) {
+
+	bool fits = true;
+
+	// all variables have to be binary
+	if (_defaultVariableType != Binary)
+		fits = false;
+
+	unsigned int v;
+	VariableType type;
+	foreach (boost::tie(v, type), _specialVariableTypes)
+		if (type != Binary)
+			fits = false;
+
+	_forest.reset(_numVariables);
+	_relaxed.clear();
+	_relaxedOf.assign(_numVariables, std::vector<unsigned int>());
+
+	if (fits) {
+
+		// keep constraints that are consistent with a forest, relax all others
+
+		foreach (const LinearConstraint& constraint, constraints) {
+
+			if (!fits || !ConflictForest::isAtMostOneConstraint(constraint)) {
+
+				fits = false;
+				break;
+			}
+
+			if (_forest.addPath(constraint))
+				continue;
+
+			unsigned int r = _relaxed.size();
+			_relaxed.push_back(std::vector<unsigned int>());
+
+			double coef;
+			foreach (boost::tie(v, coef), constraint.getCoefficients()) {
+
+				if (v >= _numVariables) {
+
+					fits = false;
+					break;
+				}
+
+				_relaxed[r].push_back(v);
+				_relaxedOf[v].push_back(r);
+			}
+		}
+	}
+
+	if (fits) {
+
+		_trees = _forest.getTrees();
+
+		LOG_USER(dualdecompositionlog)
+				<< "decomposed problem into " << _trees.size() << " trees with "
+				<< _relaxed.size() << " relaxed constraints" << std::endl;
+
+		if (_fallback) {
+
+			delete _fallback;
+			_fallback = 0;
+		}
+
+	} else if (_fallback) {
+
+		_fallback->setConstraints(constraints);
+
+	} else {
+
+		LOG_USER(dualdecompositionlog)
+				<< "problem is not a binary conflict problem, falling back to ILP solver"
+				<< std::endl;
+
+		createFallback(constraints);
+	}
+}
+
+bool
+DualDecompositionBackend::solve(Solution& solution, double& value, std::string& message) {
+
+	if (_fallback)
+		return _fallback->solve(solution, value, message);
+
+	// we minimize, flip the costs for maximization problems
+	double sign = (_objective.getSense() == Minimize ? 1.0 : -1.0);
+
+	std::vector<double> costs(_numVariables, 0.0);
+	for (unsigned int i = 0; i < std::min(_numVariables, (unsigned int)_objective.getCoefficients().size()); i++)
+		costs[i] = sign*_objective.getCoefficients()[i];
+
+	unsigned int maxIterations = optionDualDecompositionMaxIterations;
+	double       relativeGap   = optionDualDecompositionRelativeGap;
+	double       stepScale     = optionDualDecompositionStepScale;
+
+	std::vector<double> lambdas(_relaxed.size(), 0.0);
+	std::vector<double> subgradient(_relaxed.size());
+	std::vector<double> modifiedCosts(_numVariables);
+	std::vector<double> x(_numVariables);
+	std::vector<double> candidate(_numVariables);
+
+	// selecting nothing is always feasible
+	std::vector<double> best(_numVariables, 0.0);
+	double upperBound = 0;
+	double lowerBound = -std::numeric_limits<double>::infinity();
+
+	unsigned int iterationsWithoutImprovement = 0;
+	unsigned int iteration;
+
+	for (iteration = 0; iteration < maxIterations; iteration++) {
+
+		// the costs of the Lagrangian
+
+		modifiedCosts = costs;
+		double lambdaSum = 0;
+		for (unsigned int r = 0; r < _relaxed.size(); r++) {
+
+			if (lambdas[r] == 0)
+				continue;
+
+			foreach (unsigned int v, _relaxed[r])
+				modifiedCosts[v] += lambdas[r];
+			lambdaSum += lambdas[r];
+		}
+
+		double dual = solveTrees(modifiedCosts, x) - lambdaSum;
+
+		if (dual > lowerBound) {
+
+			lowerBound = dual;
+			iterationsWithoutImprovement = 0;
+
+		} else if (++iterationsWithoutImprovement >= 10) {
+
+			stepScale /= 2;
+			iterationsWithoutImprovement = 0;
+		}
+
+		double primal = repair(x, costs, candidate);
+
+		if (primal < upperBound) {
+
+			upperBound = primal;
+			std::swap(best, candidate);
+		}
+
+		LOG_DEBUG(dualdecompositionlog)
+				<< "iteration " << iteration << ": dual " << dual
+				<< ", best solution " << upperBound
+				<< ", bound " << lowerBound << std::endl;
+
+		if (upperBound - lowerBound <= relativeGap*std::max(std::abs(upperBound), 1.0))
+			break;
+
+		// projected subgradient of the dual
+
+		double norm = 0;
+		for (unsigned int r = 0; r < _relaxed.size(); r++) {
+
+			subgradient[r] = -1;
+			foreach (unsigned int v, _relaxed[r])
+				subgradient[r] += x[v];
+
+			if (lambdas[r] == 0 && subgradient[r] < 0)
+				subgradient[r] = 0;
+
+			norm += subgradient[r]*subgradient[r];
+		}
+
+		// the multipliers are optimal for the dual
+		if (norm == 0)
+			break;
+
+		double step = stepScale*(upperBound - dual)/norm;
+
+		for (unsigned int r = 0; r < _relaxed.size(); r++)
+			lambdas[r] = std::max(0.0, lambdas[r] + step*subgradient[r]);
+	}
+
+	solution.resize(_numVariables);
+	std::copy(best.begin(), best.end(), solution.getVector().begin());
+
+	value = sign*upperBound + _objective.getConstant();
+
+	double gap = upperBound - lowerBound;
+
+	LOG_USER(dualdecompositionlog)
+			<< "after " << std::min(iteration + 1, maxIterations) << " iterations: best solution "
+			<< value << ", dual bound " << (sign*lowerBound + _objective.getConstant())
+			<< ", gap " << gap << std::endl;
+
+	if (gap > relativeGap*std::max(std::abs(upperBound), 1.0)) {
+
+		std::stringstream msg;
+		msg << "solution is not optimal, duality gap is " << gap;
+		message = msg.str();
+
+		return false;
+	}
+
+	message = "Optimal solution found";
+
+	return true;
+}
+
+double
+DualDecompositionBackend::solveTrees(const std::vector<double>& costs, std::vector<double>& solution) {
+
+	_childrenValue.resize(_numVariables);
+	_excluded.resize(_numVariables);
+
+	std::vector<double> values(_trees.size());
+
+	parallel::parallelFor(
+			0, _trees.size(),
+			TreeSolver(_forest, _trees, costs, solution, _childrenValue, _excluded, values),
+			16);
+
+	double value = 0;
+	foreach (double v, values)
+		value += v;
+
+	return value;
+}
+
+double
+DualDecompositionBackend::repair(
+		const std::vector<double>& solution,
+		const std::vector<double>& costs,
+		std::vector<double>&       feasible) {
+
+	feasible.assign(_numVariables, 0.0);
+	_selectedDescendants.assign(_numVariables, 0);
+	_relaxedSelected.assign(_relaxed.size(), 0);
+
+	// first try the variables of the relaxed solution, then all other
+	// variables that improve the objective, each from cheapest to most
+	// expensive
+
+	std::vector<unsigned int> selected;
+	std::vector<unsigned int> others;
+
+	for (unsigned int v = 0; v < _numVariables; v++) {
+
+		if (costs[v] >= 0)
+			continue;
+
+		if (solution[v] == 1.0)
+			selected.push_back(v);
+		else
+			others.push_back(v);
+	}
+
+	std::sort(selected.begin(), selected.end(), CostsLess(costs));
+	std::sort(others.begin(), others.end(), CostsLess(costs));
+	selected.insert(selected.end(), others.begin(), others.end());
+
+	double value = 0;
+
+	foreach (unsigned int v, selected) {
+
+		if (!canSelect(v, feasible))
+			continue;
+
+		feasible[v] = 1.0;
+		value += costs[v];
+
+		for (unsigned int p = _forest.getParent(v); p != ConflictForest::NoParent; p = _forest.getParent(p))
+			_selectedDescendants[p]++;
+
+		foreach (unsigned int r, _relaxedOf[v])
+			_relaxedSelected[r]++;
+	}
+
+	return value;
+}
+
+bool
+DualDecompositionBackend::canSelect(unsigned int v, const std::vector<double>& feasible) {
+
+	if (_selectedDescendants[v] > 0)
+		return false;
+
+	for (unsigned int p = _forest.getParent(v); p != ConflictForest::NoParent; p = _forest.getParent(p))
+		if (feasible[p] == 1.0)
+			return false;
+
+	foreach (unsigned int r, _relaxedOf[v])
+		if (_relaxedSelected[r] > 0)
+			return false;
+
+	return true;
+}
+
+void
+DualDecompositionBackend::createFallback(const LinearConstraints& constraints) {
+
+	_fallback = DefaultFactory().createIlpSolverBackend();
+
+	_fallback->initialize(_numVariables, _defaultVariableType, _specialVariableTypes);
+	_fallback->setObjective(_objective);
+	_fallback->setConstraints(constraints);
+}
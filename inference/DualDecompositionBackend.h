@@ -0,0 +1,105 @@
+#ifndef INFERENCE_DUAL_DECOMPOSITION_BACKEND_H__
+#define INFERENCE_DUAL_DECOMPOSITION_BACKEND_H__
+
+#include <map>
+
+#include "ConflictForest.h"
+#include "LinearSolverBackend.h"
+
+/**
+ * A linear solver backend for binary problems with "at most one" constraints,
+ * as created for several merge trees by SlicesCollector:
+ *
+ * min  <a,x>
+ * s.t. sum_{i in C} x_i <= 1 for all conflict sets C
+ *      x_i \in {0,1} for all i
+ *
+ * Constraints that are root-to-leaf paths of a forest (the paths of each merge
+ * tree) are kept as hard constraints. All other constraints (the overlap
+ * conflicts between trees) are relaxed with Lagrange multipliers. The dual is
+ * maximized with projected subgradient steps, for which each tree is solved
+ * exactly and in parallel by dynamic programming. In each iteration, a
+ * feasible solution is found by greedy repair of the tree solutions.
+ *
+ * The best feasible solution is returned. The solve is reported as optimal if
+ * the relative duality gap falls below the option 'relativeGap'. Problems
+ * without this structure are passed to the ILP backend of the DefaultFactory.
+ */
+class DualDecompositionBackend : public LinearSolverBackend {
+
+public:
+
+	DualDecompositionBackend();
+
+	virtual ~DualDecompositionBackend();
+
+	///////////////////////////////////
+	// solver backend implementation //
+	///////////////////////////////////
+
+	void initialize(
+			unsigned int numVariables,
+			VariableType variableType);
+
+	void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes);
+
+	void setObjective(const LinearObjective& objective);
+
+	void setConstraints(const LinearConstraints& constraints);
+
+	bool solve(Solution& solution, double& value, std::string& message);
+
+private:
+
+	// solve all trees for the given costs, return the sum of the minimal values
+	double solveTrees(const std::vector<double>& costs, std::vector<double>& solution);
+
+	// find a feasible solution close to the given one, return its value
+	double repair(
+			const std::vector<double>& solution,
+			const std::vector<double>& costs,
+			std::vector<double>&       feasible);
+
+	// test whether a variable can be added to the current feasible solution
+	bool canSelect(unsigned int varNum, const std::vector<double>& feasible);
+
+	// create the fallback ILP solver and pass the current problem to it
+	void createFallback(const LinearConstraints& constraints);
+
+	unsigned int _numVariables;
+
+	VariableType _defaultVariableType;
+
+	std::map<unsigned int, VariableType> _specialVariableTypes;
+
+	LinearObjective _objective;
+
+	// the forest of the hard constraints
+	ConflictForest _forest;
+
+	// the trees of the forest
+	std::vector<std::vector<unsigned int> > _trees;
+
+	// the variables of each relaxed constraint
+	std::vector<std::vector<unsigned int> > _relaxed;
+
+	// the relaxed constraints of each variable
+	std::vector<std::vector<unsigned int> > _relaxedOf;
+
+	// scratch space for the tree solver
+	std::vector<double> _childrenValue;
+	std::vector<char>   _excluded;
+
+	// scratch space for the primal repair
+	std::vector<unsigned int> _selectedDescendants;
+	std::vector<unsigned int> _relaxedSelected;
+
+	// the ILP solver for problems that do not fit, or 0
+	LinearSolverBackend* _fallback;
+};
+
+#endif // INFERENCE_DUAL_DECOMPOSITION_BACKEND_H__
+
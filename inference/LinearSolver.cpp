@@ -1,3 +1,4 @@
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <util/Logger.h>
 #include <util/foreach.h>
 #include <util/helpers.hpp>
@@ -102,7 +103,19 @@ LinearSolver::solve() {
 
 	std::string message;
 
-	if (_solver->solve(*_solution, value, message)) {
+	LOG_USER(linearsolverlog)
+			<< "solving with " << _linearConstraints->size()
+			<< " linear constraints" << std::endl;
+
+	boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+	bool optimal = _solver->solve(*_solution, value, message);
+
+	boost::posix_time::time_duration duration = boost::posix_time::microsec_clock::universal_time() - start;
+
+	LOG_USER(linearsolverlog) << "solver took " << duration.total_milliseconds() << "ms" << std::endl;
+
+	if (optimal) {
 
 		LOG_USER(linearsolverlog) << "optimal solution found" << std::endl;
 
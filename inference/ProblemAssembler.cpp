@@ -44,7 +44,7 @@ ProblemAssembler::updateOutputs() {
 
 	// create one linear constraint per conflict set
 
-	foreach (const ConflictSet& conflictSet, *_conflictSets) {
+	foreach (const ConflictSetView& conflictSet, *_conflictSets) {
 
 		LinearConstraint constraint;
 
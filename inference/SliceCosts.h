@@ -2,6 +2,7 @@
 #define MULTI2CUT_INFERENCE_SLICE_COSTS_H__
 
 #include <pipeline/Data.h>
+#include <slices/SliceIdMap.h>
 
 class SliceCosts {
 
@@ -14,10 +15,10 @@ public:
 
 	double getCosts(unsigned int sliceId) {
 
-		if (_costs.count(sliceId) == 0)
+		if (!_costs.contains(sliceId))
 			return 0;
 
-		return _costs[sliceId];
+		return _costs.at(sliceId);
 	}
 
 	void clear() {
@@ -27,7 +28,7 @@ public:
 
 private:
 
-	std::map<unsigned int, double> _costs;
+	SliceIdMap<double> _costs;
 };
 
 #endif // MULTI2CUT_INFERENCE_SLICE_COSTS_H__
@@ -1,7 +1,8 @@
 #ifndef MULTI2CUT_INFERENCE_SLICE_VARIABLE_MAP_H__
 #define MULTI2CUT_INFERENCE_SLICE_VARIABLE_MAP_H__
 
-#include <map>
+#include <vector>
+#include <slices/SliceIdMap.h>
 
 class SliceVariableMap {
 
@@ -9,6 +10,9 @@ public:
 
 	void associate(unsigned int sliceId, unsigned int variableNum) {
 
+		if (variableNum >= _varToSlice.size())
+			_varToSlice.resize(variableNum + 1);
+
 		_varToSlice[variableNum] = sliceId;
 		_sliceToVar[sliceId] = variableNum;
 	}
@@ -31,8 +35,8 @@ public:
 
 private:
 
-	std::map<unsigned int, unsigned int> _varToSlice;
-	std::map<unsigned int, unsigned int> _sliceToVar;
+	std::vector<unsigned int> _varToSlice;
+	SliceIdMap<unsigned int>  _sliceToVar;
 };
 
 #endif // MULTI2CUT_INFERENCE_SLICE_VARIABLE_MAP_H__
@@ -0,0 +1,133 @@
+#include <util/Logger.h>
+#include <util/foreach.h>
+#include "DefaultFactory.h"
+#include "TreeSolverBackend.h"
+
+logger::LogChannel treesolverlog("treesolverlog", "[TreeSolverBackend] ");
+
+TreeSolverBackend::TreeSolverBackend() :
+	_numVariables(0),
+	_defaultVariableType(Continuous),
+	_fallback(0) {}
+
+TreeSolverBackend::~TreeSolverBackend() {
+
+	if (_fallback)
+		delete _fallback;
+}
+
+void
+TreeSolverBackend::initialize(
+		unsigned int numVariables,
+		VariableType variableType) {
+
+	initialize(numVariables, variableType, std::map<unsigned int, VariableType>());
+}
+
+void
+TreeSolverBackend::initialize(
+		unsigned int                                numVariables,
+		VariableType                                defaultVariableType,
+		const std::map<unsigned int, VariableType>& specialVariableTypes) {
+
+	_numVariables         = numVariables;
+	_defaultVariableType  = defaultVariableType;
+	_specialVariableTypes = specialVariableTypes;
+
+	if (_fallback)
+		_fallback->initialize(numVariables, defaultVariableType, specialVariableTypes);
+}
+
+void
+TreeSolverBackend::setObjective(const LinearObjective& objective) {
+
+	_objective = objective;
+
+	if (_fallback)
+		_fallback->setObjective(objective);
+}
+
+void
+TreeSolverBackend::setConstraints(const LinearConstraints& constraints) {
+
+	bool isForest = true;
+
+	// all variables have to be binary
+	if (_defaultVariableType != Binary)
+		isForest = false;
+
+	unsigned int v;
+	VariableType type;
+	foreach (boost::tie(v, type), _specialVariableTypes)
+		if (type != Binary)
+			isForest = false;
+
+	_forest.reset(_numVariables);
+
+	if (isForest) {
+
+		foreach (const LinearConstraint& constraint, constraints)
+			if (!ConflictForest::isAtMostOneConstraint(constraint) || !_forest.addPath(constraint)) {
+
+				isForest = false;
+				break;
+			}
+	}
+
+	if (isForest) {
+
+		LOG_DEBUG(treesolverlog)
+				<< "constraints form a forest over " << _numVariables
+				<< " variables, using dynamic programming" << std::endl;
+
+		if (_fallback) {
+
+			delete _fallback;
+			_fallback = 0;
+		}
+
+	} else if (_fallback) {
+
+		_fallback->setConstraints(constraints);
+
+	} else {
+
+		LOG_USER(treesolverlog)
+				<< "problem is not a binary forest problem, falling back to ILP solver"
+				<< std::endl;
+
+		createFallback(constraints);
+	}
+}
+
+bool
+TreeSolverBackend::solve(Solution& solution, double& value, std::string& message) {
+
+	if (_fallback)
+		return _fallback->solve(solution, value, message);
+
+	// we minimize, flip the costs for maximization problems
+	double sign = (_objective.getSense() == Minimize ? 1.0 : -1.0);
+
+	std::vector<double> costs(_numVariables, 0.0);
+	for (unsigned int i = 0; i < std::min(_numVariables, (unsigned int)_objective.getCoefficients().size()); i++)
+		costs[i] = sign*_objective.getCoefficients()[i];
+
+	solution.resize(_numVariables);
+
+	value = sign*_forest.solve(costs, solution.getVector()) + _objective.getConstant();
+
+	message = "Optimal solution found";
+
+	return true;
+}
+
+void
+TreeSolverBackend::createFallback(const LinearConstraints& constraints) {
+
+	_fallback = DefaultFactory().createIlpSolverBackend();
+
+	_fallback->initialize(_numVariables, _defaultVariableType, _specialVariableTypes);
+	_fallback->setObjective(_objective);
+	_fallback->setConstraints(constraints);
+}
@@ -0,0 +1,69 @@
+#ifndef INFERENCE_TREE_SOLVER_BACKEND_H__
+#define INFERENCE_TREE_SOLVER_BACKEND_H__
+
+#include <map>
+
+#include "ConflictForest.h"
+#include "LinearSolverBackend.h"
+
+/**
+ * A linear solver backend for binary problems whose constraints are the
+ * root-to-leaf paths of a forest, as created for a single merge tree:
+ *
+ * min  <a,x>
+ * s.t. sum_{i in P} x_i <= 1 for all paths P
+ *      x_i \in {0,1} for all i
+ *
+ * Such problems are solved exactly in linear time by dynamic programming on the
+ * forest. If the problem does not have this structure, the solver falls back
+ * to the ILP backend of the DefaultFactory.
+ */
+class TreeSolverBackend : public LinearSolverBackend {
+
+public:
+
+	TreeSolverBackend();
+
+	virtual ~TreeSolverBackend();
+
+	///////////////////////////////////
+	// solver backend implementation //
+	///////////////////////////////////
+
+	void initialize(
+			unsigned int numVariables,
+			VariableType variableType);
+
+	void initialize(
+			unsigned int                                numVariables,
+			VariableType                                defaultVariableType,
+			const std::map<unsigned int, VariableType>& specialVariableTypes);
+
+	void setObjective(const LinearObjective& objective);
+
+	void setConstraints(const LinearConstraints& constraints);
+
+	bool solve(Solution& solution, double& value, std::string& message);
+
+private:
+
+	// create the fallback ILP solver and pass the current problem to it
+	void createFallback(const LinearConstraints& constraints);
+
+	unsigned int _numVariables;
+
+	VariableType _defaultVariableType;
+
+	std::map<unsigned int, VariableType> _specialVariableTypes;
+
+	LinearObjective _objective;
+
+	// the forest of the current constraints, if they are paths
+	ConflictForest _forest;
+
+	// the ILP solver for problems that are not forests, or 0
+	LinearSolverBackend* _fallback;
+};
+
+#endif // INFERENCE_TREE_SOLVER_BACKEND_H__
+
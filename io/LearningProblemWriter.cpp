@@ -70,7 +70,7 @@ LearningProblemWriter::write() {
 
 	std::ofstream constraintsFile((_directory + "/constraints.txt").c_str());
 
-	foreach (ConflictSet& conflictSet, *_conflictSets) {
+	foreach (const ConflictSetView& conflictSet, *_conflictSets) {
 
 		foreach (unsigned int sliceId, conflictSet.getSlices()) {
 
@@ -84,15 +84,11 @@ LearningProblemWriter::write() {
 
 	std::ofstream labelsFile((_directory + "/labels.txt").c_str());
 
-	std::set<unsigned int> bestEffortSliceIds;
-	foreach (boost::shared_ptr<Slice> slice, *_bestEffort)
-		bestEffortSliceIds.insert(slice->getId());
-
 	for (unsigned int varNum = 0; varNum < nextVarNum; varNum++) {
 
 		unsigned int sliceId = sliceVariableMap.getSliceId(varNum);
 
-		if (bestEffortSliceIds.count(sliceId))
+		if (_bestEffort->contains(sliceId))
 			labelsFile << 1 << std::endl;
 		else
 			labelsFile << 0 << std::endl;
@@ -0,0 +1,27 @@
+#include <util/Logger.h>
+#include <mergetree/MergeHistory.h>
+#include <slices/MergeHistoryConverter.h>
+#include "MergeHistoryReader.h"
+
+static logger::LogChannel mergehistoryreaderlog("mergehistoryreaderlog", "[MergeHistoryReader] ");
+
+MergeHistoryReader::MergeHistoryReader(const std::string& filename) :
+	_slices(new SlicesTree()),
+	_conflictSets(new ConflictSets()),
+	_filename(filename) {
+
+	registerOutput(_slices, "slices");
+	registerOutput(_conflictSets, "conflict sets");
+}
+
+void
+MergeHistoryReader::updateOutputs() {
+
+	LOG_DEBUG(mergehistoryreaderlog) << "reading merge history from " << _filename << std::endl;
+
+	MergeHistory mergeHistory;
+	mergeHistory.read(_filename);
+
+	MergeHistoryConverter converter(0);
+	converter.convert(mergeHistory, *_slices, *_conflictSets);
+}
@@ -0,0 +1,30 @@
+#ifndef MULTI2CUT_IO_MERGE_HISTORY_READER_H__
+#define MULTI2CUT_IO_MERGE_HISTORY_READER_H__
+
+#include <string>
+#include <pipeline/SimpleProcessNode.h>
+#include <slices/ConflictSets.h>
+#include <slices/SlicesTree.h>
+
+/**
+ * Reads a merge-history file written by merge_tree and provides the slices
+ * and conflict sets of the merge tree, like MergeTreeReader does for a 
+ * merge-tree image.
+ */
+class MergeHistoryReader : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	MergeHistoryReader(const std::string& filename);
+
+private:
+
+	void updateOutputs();
+
+	pipeline::Output<SlicesTree>   _slices;
+	pipeline::Output<ConflictSets> _conflictSets;
+
+	std::string _filename;
+};
+
+#endif // MULTI2CUT_IO_MERGE_HISTORY_READER_H__
@@ -1,13 +1,26 @@
 #include "MergeTreeReader.h"
+#include <boost/make_shared.hpp>
 #include <util/ProgramOptions.h>
+#include <mergetree/MergeHistory.h>
 
 util::ProgramOption optionSpacedEdgeImage(
 		util::_long_name        = "spacedEdgeImage",
 		util::_description_text = "Indicate that the merge tree image(s) are spaced edge images (if they are, you would know).");
 
-MergeTreeReader::MergeTreeReader(std::string mergeTreeImage) :
-	_imageReader(mergeTreeImage),
-	_sliceExtractor(0, true /* downsample */, false /* brightToDark */, optionSpacedEdgeImage) {
+MergeTreeReader::MergeTreeReader(std::string mergeTreeFile) {
+
+	if (MergeHistory::isMergeHistoryFile(mergeTreeFile)) {
+
+		_mergeHistoryReader = boost::make_shared<MergeHistoryReader>(mergeTreeFile);
+
+		registerOutput(_mergeHistoryReader->getOutput("slices"), "slices");
+		registerOutput(_mergeHistoryReader->getOutput("conflict sets"), "conflict sets");
+
+		return;
+	}
+
+	_imageReader    = boost::make_shared<ImageReader>(mergeTreeFile);
+	_sliceExtractor = boost::make_shared<SliceExtractor<unsigned short> >(0, true /* downsample */, false /* brightToDark */, optionSpacedEdgeImage);
 
 	registerOutput(_sliceExtractor->getOutput("slices"), "slices");
 	registerOutput(_sliceExtractor->getOutput("conflict sets"), "conflict sets");
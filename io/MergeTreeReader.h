@@ -1,11 +1,16 @@
 #ifndef MULTI2CUT_IO_MERGE_TREE_READER_H__
 #define MULTI2CUT_IO_MERGE_TREE_READER_H__
 
+#include <boost/shared_ptr.hpp>
 #include <pipeline/SimpleProcessNode.h>
-#include <pipeline/Process.h>
 #include <imageprocessing/io/ImageReader.h>
 #include <slices/SliceExtractor.h>
+#include "MergeHistoryReader.h"
 
+/**
+ * Reads the slices and conflict sets of a merge tree, given either as a 
+ * merge-tree image or as a merge-history file.
+ */
 class MergeTreeReader : public pipeline::SimpleProcessNode<> {
 
 public:
@@ -16,9 +21,9 @@ private:
 
 	void updateOutputs() {}
 
-	pipeline::Process<ImageReader>                     _imageReader;
-	pipeline::Process<SliceExtractor<unsigned short> > _sliceExtractor;
+	boost::shared_ptr<ImageReader>                     _imageReader;
+	boost::shared_ptr<SliceExtractor<unsigned short> > _sliceExtractor;
+	boost::shared_ptr<MergeHistoryReader>              _mergeHistoryReader;
 };
 
 #endif // MULTI2CUT_IO_MERGE_TREE_READER_H__
-
@@ -31,11 +31,13 @@ SlicesWriter::write() {
 		std::stringstream sliceNumber;
 		sliceNumber << std::setw(8) << std::setfill('0') << slice->getId();
 
-		util::rect<unsigned int> boundingBox = slice->getComponent()->getBoundingBox();
+		boost::shared_ptr<ConnectedComponent> component = slice->getComponent();
+
+		util::rect<unsigned int> boundingBox = component->getBoundingBox();
 
 		std::string imageFilename = "output_images/slices/slice_" + sliceNumber.str() + ".png";
 
-		const ConnectedComponent::bitmap_type& bitmap = slice->getComponent()->getBitmap();
+		const ConnectedComponent::bitmap_type& bitmap = component->getBitmap();
 
 		storeSliceBitmap(bitmap, imageFilename);
 
@@ -9,6 +9,33 @@ util::ProgramOption optionSolutionWithBorders(
 
 logger::LogChannel solutionwriterlog("solutionwriterlog", "[SolutionWriter] ");
 
+namespace {
+
+// sets the visited pixels to the id of a slice
+struct PixelSetter {
+
+	PixelSetter(Image& segmentation, unsigned int sliceId) :
+		segmentation(segmentation),
+		sliceId(sliceId) {}
+
+	void operator()(const util::point<unsigned int>& p) {
+
+		if (segmentation(p.x, p.y) != 0)
+			LOG_ERROR(solutionwriterlog)
+					<< "inconsistency in solution: pixel " << p
+					<< " is part of at least two slices: "
+					<< segmentation(p.x, p.y) << " and "
+					<< sliceId << std::endl;
+
+		segmentation(p.x, p.y) = sliceId;
+	}
+
+	Image&       segmentation;
+	unsigned int sliceId;
+};
+
+} // anonymous namespace
+
 SolutionWriter::SolutionWriter(unsigned int width, unsigned int height, const std::string& filename) :
 	_width(width),
 	_height(height),
@@ -26,17 +53,8 @@ SolutionWriter::write() {
 
 	foreach (boost::shared_ptr<Slice> slice, *_solution) {
 
-		foreach (const util::point<unsigned int>& p, slice->getComponent()->getPixels()) {
-
-			if (segmentation(p.x, p.y) != 0)
-				LOG_ERROR(solutionwriterlog)
-						<< "inconsistency in solution: pixel " << p
-						<< " is part of at least two slices: "
-						<< segmentation(p.x, p.y) << " and "
-						<< slice->getId() << std::endl;
-
-			segmentation(p.x, p.y) = slice->getId();
-		}
+		PixelSetter setter(segmentation, slice->getId());
+		slice->forEachPixel(setter);
 	}
 
 	if (optionSolutionWithBorders) {
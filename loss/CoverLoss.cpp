@@ -1,9 +1,31 @@
+#include <imageprocessing/ConnectedComponent.h>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include "CoverLoss.h"
 
 logger::LogChannel coverlosslog("coverlosslog", "[CoverLoss] ");
 
+namespace {
+
+// checks whether any visited pixel is a centroid
+struct CentroidFinder {
+
+	CentroidFinder(const vigra::MultiArray<2, bool>& centroids) :
+		centroids(centroids),
+		found(false) {}
+
+	void operator()(const util::point<unsigned int>& p) {
+
+		if (centroids(p.x, p.y))
+			found = true;
+	}
+
+	const vigra::MultiArray<2, bool>& centroids;
+	bool found;
+};
+
+} // anonymous namespace
+
 CoverLoss::CoverLoss() {
 
 	registerInput(_slices, "slices");
@@ -23,9 +45,9 @@ CoverLoss::updateOutputs() {
 	// get the bounding box of all slices (gt and candidates)
 	util::rect<unsigned int> bb(0, 0, 0, 0);
 	foreach (boost::shared_ptr<Slice> slice, *_slices)
-		bb.fit(slice->getComponent()->getBoundingBox());
+		bb.fit(slice->getBoundingBox());
 	foreach (boost::shared_ptr<Slice> slice, *_groundTruth)
-		bb.fit(slice->getComponent()->getBoundingBox());
+		bb.fit(slice->getBoundingBox());
 
 	// make sure (0,0) is included
 	bb.fit(util::point<unsigned int>(0, 0));
@@ -39,7 +61,7 @@ CoverLoss::updateOutputs() {
 	_centroids = false;
 	foreach (boost::shared_ptr<Slice> slice, *_groundTruth) {
 
-		util::point<unsigned int> centroid = slice->getComponent()->getCenter();
+		util::point<unsigned int> centroid = slice->getCenter();
 		_centroids(centroid.x, centroid.y) = true;
 
 		// constant is total number of centroids
@@ -51,16 +73,15 @@ CoverLoss::updateOutputs() {
 	// set candidate scores
 	foreach (boost::shared_ptr<Slice> slice, *_slices) {
 
-		bool coversCentroid = false;
-		foreach (const util::point<unsigned int>& p, slice->getComponent()->getPixels()) {
+		bool coversCentroid;
 
-			if (_centroids(p.x, p.y)) {
+		if (slice->getPixelRange().valid())
+			coversCentroid = coversCentroidRange(slice->getPixelRange());
+		else
+			coversCentroid = coversCentroidPixels(*slice);
 
-				coversCentroid = true;
-				LOG_ALL(coverlosslog) << "slice " << slice->getId() << " covers at least one centroid" << std::endl;
-				break;
-			}
-		}
+		if (coversCentroid)
+			LOG_ALL(coverlosslog) << "slice " << slice->getId() << " covers at least one centroid" << std::endl;
 
 		(*_lossFunction)[slice->getId()] = (coversCentroid ? -1.0 : 0.0);
 		LOG_ALL(coverlosslog) << "loss of slice " << slice->getId() << " = " << (*_lossFunction)[slice->getId()] << std::endl;
@@ -68,6 +89,41 @@ CoverLoss::updateOutputs() {
 
 	// set the constant
 	_lossFunction->setConstant(_constant);
+
+	_centroidCounts.clear();
+}
+
+
+
+bool
+CoverLoss::coversCentroidPixels(const Slice& slice) {
+
+	CentroidFinder finder(_centroids);
+	slice.forEachPixel(finder);
+
+	return finder.found;
 }
 
+bool
+CoverLoss::coversCentroidRange(const PixelRange& range) {
+
+	const PixelList* pixelList = range.getPixelList().get();
+
+	std::map<const PixelList*, std::vector<unsigned int> >::iterator i = _centroidCounts.find(pixelList);
+
+	// the number of centroids among the first k pixels of the list, for all k
+	if (i == _centroidCounts.end()) {
 
+		std::vector<unsigned int> counts(1, 0);
+		counts.reserve(pixelList->size() + 1);
+
+		for (PixelList::const_iterator p = pixelList->begin(); p != pixelList->end(); p++)
+			counts.push_back(counts.back() + (_centroids(p->x, p->y) ? 1 : 0));
+
+		i = _centroidCounts.insert(std::make_pair(pixelList, counts)).first;
+	}
+
+	const std::vector<unsigned int>& counts = i->second;
+
+	return counts[range.offset() + range.size()] > counts[range.offset()];
+}
@@ -1,6 +1,8 @@
 #ifndef MULTI2CUT_LOSS_COVER_LOSS_H__
 #define MULTI2CUT_LOSS_COVER_LOSS_H__
 
+#include <map>
+#include <vector>
 #include <pipeline/SimpleProcessNode.h>
 #include <slices/SlicesTree.h>
 #include "LossFunction.h"
@@ -39,6 +41,10 @@ private:
 
 	void updateOutputs();
 
+	bool coversCentroidPixels(const Slice& slice);
+
+	bool coversCentroidRange(const PixelRange& range);
+
 	pipeline::Input<SlicesTree>    _slices;
 	pipeline::Input<Slices>        _groundTruth;
 	pipeline::Output<LossFunction> _lossFunction;
@@ -46,6 +52,9 @@ private:
 	double _constant;
 
 	vigra::MultiArray<2, bool> _centroids;
+
+	// prefix counts of centroids along pixel lists shared by nested slices
+	std::map<const PixelList*, std::vector<unsigned int> > _centroidCounts;
 };
 
 #endif // MULTI2CUT_LOSS_COVER_LOSS_H__
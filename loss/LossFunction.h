@@ -1,6 +1,8 @@
 #ifndef MULTI2CUT_LOSS_LOSS_FUNCTION_H__
 #define MULTI2CUT_LOSS_LOSS_FUNCTION_H__
 
+#include <slices/SliceIdMap.h>
+
 class LossFunction {
 
 public:
@@ -8,9 +10,9 @@ public:
 	LossFunction() :
 		_constant(0) {}
 
-	typedef std::map<unsigned int, double>                 losses_type;
-	typedef std::map<unsigned int, double>::iterator       iterator;
-	typedef std::map<unsigned int, double>::const_iterator const_iterator;
+	typedef SliceIdMap<double>                 losses_type;
+	typedef SliceIdMap<double>::iterator       iterator;
+	typedef SliceIdMap<double>::const_iterator const_iterator;
 
 	const double& operator[](unsigned int id) const { return _losses.at(id); }
 
@@ -20,9 +22,7 @@ public:
 
 	double getConstant() { return _constant; }
 
-	losses_type::iterator begin() { return _losses.begin(); }
 	losses_type::const_iterator begin() const { return _losses.begin(); }
-	losses_type::iterator end() { return _losses.end(); }
 	losses_type::const_iterator end() const { return _losses.end(); }
 
 	void clear() { _losses.clear(); _constant = 0; }
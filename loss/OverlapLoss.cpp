@@ -54,9 +54,9 @@ OverlapLoss::computeMaxGroundTruthOverlap(const Slice& slice) {
 	double setDifference;
 
 	if (maxOverlapGtSlice)
-		setDifference = slice.getComponent()->getSize() + maxOverlapGtSlice->getComponent()->getSize() - 2*maxOverlap;
+		setDifference = slice.getSize() + maxOverlapGtSlice->getSize() - 2*maxOverlap;
 	else
-		setDifference = slice.getComponent()->getSize();
+		setDifference = slice.getSize();
 
 	return _setDifferenceScale*setDifference - maxOverlap;
 }
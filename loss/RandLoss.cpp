@@ -1,3 +1,4 @@
+#include <vector>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include <util/helpers.hpp>
@@ -53,8 +54,7 @@ RandLoss::updateOutputs() {
 	for (unsigned int i = 0; i < _slices.size(); i++) {
 
 		// get the rand costs
-		foreach (boost::shared_ptr<SlicesTree::Node> root, _slices[i]->getRoots())
-			traverseAboveBestEffort(root, *_bestEffort[i]);
+		assignCosts(*_slices[i], *_bestEffort[i]);
 	}
 
 	// get the negative cost of the best effort solution
@@ -68,101 +68,87 @@ RandLoss::updateOutputs() {
 }
 
 void
-RandLoss::traverseAboveBestEffort(boost::shared_ptr<SlicesTree::Node> node, const Slices& bestEffort) {
+RandLoss::assignCosts(const SlicesTree& slices, const Slices& bestEffort) {
 
-	boost::shared_ptr<Slice> slice = node->getSlice();
+	// whether a node is a best-effort node or a descendant of one
+	std::vector<char> belowBestEffort(slices.numNodes(), false);
 
-	double size = slice->getComponent()->getSize();
+	// the sum of the sizes and of the squared sizes of the best-effort 
+	// descendants of each node above best-effort
+	std::vector<double> sumSizes(slices.numNodes(), 0);
+	std::vector<double> sumSquaredSizes(slices.numNodes(), 0);
 
-	LOG_DEBUG(randlosslog)
-			<< "entering slice " << slice->getId()
-			<< ", size = " << size
-			<< std::endl;
+	foreach (SlicesTree::NodeId root, slices.getRoots()) {
 
-	bool isBestEffort = (std::find(bestEffort.begin(), bestEffort.end(), slice) != bestEffort.end());
+		// assign the costs of best-effort nodes and their descendants
+		for (SlicesTree::PreOrderIterator i(slices, root); !i.done(); ++i) {
 
-	LOG_DEBUG(randlosslog) << "\tis best effort: " << isBestEffort << std::endl;
+			SlicesTree::NodeId node   = *i;
+			SlicesTree::NodeId parent = slices.getParent(node);
 
-	if (isBestEffort) {
+			boost::shared_ptr<Slice> slice = slices.getSlice(node);
 
-		// this assigns the cost to node and all descendants
-		traverseBelowBestEffort(node);
+			if ((parent == SlicesTree::NoNode || !belowBestEffort[parent]) && !bestEffort.contains(slice->getId()))
+				continue;
 
-		return;
-	}
-
-	std::vector<size_t> descendantBestEffortSizes = getDescentantBestEffortSizes(node, bestEffort);
-
-	LOG_DEBUG(randlosslog) << "\tthis slice has " << descendantBestEffortSizes.size() << " best-effort descendants" << std::endl;
-	LOG_DEBUG(randlosslog) << "\twith sizes " << descendantBestEffortSizes << std::endl;
-
-	// we are above the best effort solution
-
-	double costs = 0;
-	for (int i = 0; i < descendantBestEffortSizes.size(); i++) {
+			belowBestEffort[node] = true;
 
-		double a = descendantBestEffortSizes[i];
+			double size = slice->getSize();
 
-		costs += a*(a-1)/2;
+			LOG_DEBUG(randlosslog)
+					<< "slice " << slice->getId()
+					<< ", size = " << size
+					<< " is below best-effort"
+					<< std::endl;
 
-		for (int j = i + 1; j < descendantBestEffortSizes.size(); j++) {
-
-			double b = descendantBestEffortSizes[j];
-			costs -= a*b;
+			double costs = size*(size - 1)/2;
+			(*_lossFunction)[slice->getId()] = -costs;
 		}
-	}
 
-	LOG_DEBUG(randlosslog) << "\tthis slice is above best-effort, assign total costs of " << costs << std::endl;
+		// assign the costs above best-effort nodes, children first
+		for (SlicesTree::PostOrderIterator i(slices, root); !i.done(); ++i) {
 
-	(*_lossFunction)[slice->getId()] = -costs;
+			SlicesTree::NodeId node = *i;
 
-	// visit children
+			if (belowBestEffort[node])
+				continue;
 
-	foreach (boost::shared_ptr<SlicesTree::Node> child, node->getChildren()) {
+			boost::shared_ptr<Slice> slice = slices.getSlice(node);
 
-		traverseAboveBestEffort(child, bestEffort);
-	}
-}
+			for (SlicesTree::NodeId child = slices.getFirstChild(node); child != SlicesTree::NoNode; child = slices.getNextSibling(child)) {
 
-void
-RandLoss::traverseBelowBestEffort(boost::shared_ptr<SlicesTree::Node> node) {
-
-	boost::shared_ptr<Slice> slice = node->getSlice();
-
-	double size = slice->getComponent()->getSize();
-
-	LOG_DEBUG(randlosslog)
-			<< "entering slice " << slice->getId()
-			<< ", size = " << size
-			<< std::endl;
+				if (belowBestEffort[child]) {
 
-	double costs = size*(size - 1)/2;
-	(*_lossFunction)[slice->getId()] = -costs;
+					// a best-effort child
+					double size = slices.getSlice(child)->getSize();
 
-	foreach (boost::shared_ptr<SlicesTree::Node> child, node->getChildren())
-		traverseBelowBestEffort(child);
-}
-
-std::vector<size_t>
-RandLoss::getDescentantBestEffortSizes(boost::shared_ptr<SlicesTree::Node> node, const Slices& bestEffort) {
+					sumSizes[node]        += size;
+					sumSquaredSizes[node] += size*size;
 
-	boost::shared_ptr<Slice> slice = node->getSlice();
-	bool isBestEffort = (std::find(bestEffort.begin(), bestEffort.end(), slice) != bestEffort.end());
+				} else {
 
-	std::vector<size_t> sizes;
+					sumSizes[node]        += sumSizes[child];
+					sumSquaredSizes[node] += sumSquaredSizes[child];
+				}
+			}
 
-	if (isBestEffort) {
+			// For best-effort descendants of sizes a_i, the costs are
+			//
+			//   sum_i a_i(a_i - 1)/2 - sum_{i<j} a_i a_j,
+			//
+			// which can be written in terms of the sums of sizes and squared 
+			// sizes only.
+			double s1 = sumSizes[node];
+			double s2 = sumSquaredSizes[node];
 
-		sizes.push_back(slice->getComponent()->getSize());
+			double costs = (s2 - s1)/2 - (s1*s1 - s2)/2;
 
-	} else {
+			LOG_DEBUG(randlosslog)
+					<< "slice " << slice->getId()
+					<< " is above best-effort, assign total costs of " << costs
+					<< std::endl;
 
-		foreach (boost::shared_ptr<SlicesTree::Node> child, node->getChildren()) {
-
-			std::vector<size_t> childSizes = getDescentantBestEffortSizes(child, bestEffort);
-			std::copy(childSizes.begin(), childSizes.end(), std::back_inserter(sizes));
+			(*_lossFunction)[slice->getId()] = -costs;
 		}
 	}
-
-	return sizes;
 }
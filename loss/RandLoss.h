@@ -15,11 +15,10 @@ private:
 
 	void updateOutputs();
 
-	void traverseAboveBestEffort(boost::shared_ptr<SlicesTree::Node> node, const Slices& bestEffort);
-
-	void traverseBelowBestEffort(boost::shared_ptr<SlicesTree::Node> node);
-
-	std::vector<size_t> getDescentantBestEffortSizes(boost::shared_ptr<SlicesTree::Node> node, const Slices& bestEffort);
+	/**
+	 * Assign the costs to all nodes of a tree, given its best-effort slices.
+	 */
+	void assignCosts(const SlicesTree& slices, const Slices& bestEffort);
 
 	pipeline::Inputs<SlicesTree>   _slices;
 	pipeline::Inputs<Slices>       _bestEffort;
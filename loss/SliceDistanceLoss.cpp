@@ -19,15 +19,21 @@ SliceDistanceLoss::updateOutputs() {
 
 	_lossFunction->clear();
 
+	// find the close ground-truth slices for all slices at once
+	std::vector<util::point<double> > centers;
+	centers.reserve(_slices->size());
 	foreach (boost::shared_ptr<Slice> slice, *_slices)
-		getLoss(*slice);
+		centers.push_back(slice->getCenter());
+
+	std::vector<std::vector<boost::shared_ptr<Slice> > > gtSlices =
+			_groundTruth->findAll(centers, _maxSliceDistance);
+
+	for (unsigned int i = 0; i < _slices->size(); i++)
+		getLoss(*(*_slices)[i], gtSlices[i]);
 }
 
 void
-SliceDistanceLoss::getLoss(const Slice& slice) {
-
-	std::vector<boost::shared_ptr<Slice> > gtSlices =
-			_groundTruth->find(slice.getComponent()->getCenter(), _maxSliceDistance);
+SliceDistanceLoss::getLoss(const Slice& slice, const std::vector<boost::shared_ptr<Slice> >& gtSlices) {
 
 	double minDistance = _sliceDiameter(slice);
 
@@ -17,7 +17,7 @@ private:
 
 	void updateOutputs();
 
-	void getLoss(const Slice& slice);
+	void getLoss(const Slice& slice, const std::vector<boost::shared_ptr<Slice> >& gtSlices);
 
 	pipeline::Input<Slices>        _slices;
 	pipeline::Input<Slices>        _groundTruth;
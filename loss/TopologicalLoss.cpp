@@ -1,3 +1,5 @@
+#include <limits>
+#include <vector>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include "TopologicalLoss.h"
@@ -52,115 +54,113 @@ TopologicalLoss::updateOutputs() {
 	for (unsigned int i = 0; i < _slices.size(); i++) {
 
 		// get the topological costs
-		foreach (boost::shared_ptr<SlicesTree::Node> root, _slices[i]->getRoots())
-			traverseAboveBestEffort(root, *_bestEffort[i]);
+		assignCosts(*_slices[i], *_bestEffort[i]);
 	}
 
-
 	// set the constant
 	_lossFunction->setConstant(_constant);
 }
 
-TopologicalLoss::NodeCosts
-TopologicalLoss::traverseAboveBestEffort(boost::shared_ptr<SlicesTree::Node> node, const Slices& bestEffort) {
+void
+TopologicalLoss::assignCosts(const SlicesTree& slices, const Slices& bestEffort) {
 
-	boost::shared_ptr<Slice> slice = node->getSlice();
+	// the costs of each node, indexed by node id
+	std::vector<NodeCosts> costs(slices.numNodes());
 
-	LOG_DEBUG(topologicallosslog)
-			<< "entering slice " << slice->getId()
-			<< ", size = " << slice->getComponent()->getSize()
-			<< std::endl;
+	// whether a node is a best-effort node or a descendant of one
+	std::vector<char> belowBestEffort(slices.numNodes(), false);
 
-	bool isBestEffort = (std::find(bestEffort.begin(), bestEffort.end(), slice) != bestEffort.end());
+	foreach (SlicesTree::NodeId root, slices.getRoots()) {
 
-	LOG_DEBUG(topologicallosslog) << "\tis best effort: " << isBestEffort << std::endl;
+		// assign the costs from best-effort nodes downwards, parents first
+		for (SlicesTree::PreOrderIterator i(slices, root); !i.done(); ++i) {
 
-	if (isBestEffort) {
+			SlicesTree::NodeId node   = *i;
+			SlicesTree::NodeId parent = slices.getParent(node);
 
-		NodeCosts bestEffortCosts;
-		bestEffortCosts.split = 0;
-		bestEffortCosts.merge = 0;
-		bestEffortCosts.fp    = 0;
-		bestEffortCosts.fn    = -_weightFn;
-		_constant += _weightFn;
+			boost::shared_ptr<Slice> slice = slices.getSlice(node);
 
-		// this assigns the cost to node and all descendants
-		traverseBelowBestEffort(node, bestEffortCosts);
+			if (parent != SlicesTree::NoNode && belowBestEffort[parent]) {
 
-		return bestEffortCosts;
-	}
+				double k = slices.getNumChildren(parent);
 
-	unsigned int numChildren = node->getChildren().size();
+				// the costs of the children of a node below best-effort
+				costs[node].split = costs[parent].split + _weightSplit*(k - 1)/k;
+				costs[node].merge = 0;
+				costs[node].fn    = costs[parent].fn/k;
+				costs[node].fp    = 0;
 
-	LOG_DEBUG(topologicallosslog) << "\tthis slice has " << numChildren << " children" << std::endl;
+			} else if (bestEffort.contains(slice->getId())) {
 
-	if (numChildren == 0) {
+				LOG_DEBUG(topologicallosslog) << "slice " << slice->getId() << " is best effort" << std::endl;
 
-		// We are above best-effort, and we don't have children -- this slice 
-		// belongs to a path that is completely spurious.
+				costs[node].split = 0;
+				costs[node].merge = 0;
+				costs[node].fp    = 0;
+				costs[node].fn    = -_weightFn;
+				_constant += _weightFn;
 
-		// give it false positive costs
-		NodeCosts falsePositiveCosts;
-		falsePositiveCosts.split = 0;
-		falsePositiveCosts.merge = 0;
-		falsePositiveCosts.fp    = _weightFp;
-		falsePositiveCosts.fn    = 0;
+			} else {
 
-		(*_lossFunction)[slice->getId()] = falsePositiveCosts;
+				continue;
+			}
 
-		return falsePositiveCosts;
-	}
+			belowBestEffort[node] = true;
 
-	// we are above the best effort solution
+			(*_lossFunction)[slice->getId()] = costs[node];
+		}
 
-	// get our node costs from the costs of our children
-	double sumChildMergeCosts = 0;
-	double sumChildFnCosts    = 0;
-	double minChildFpCosts    = std::numeric_limits<double>::infinity();
-	foreach (boost::shared_ptr<SlicesTree::Node> child, node->getChildren()) {
+		// assign the costs above best-effort nodes, children first
+		for (SlicesTree::PostOrderIterator i(slices, root); !i.done(); ++i) {
 
-		NodeCosts childCosts = traverseAboveBestEffort(child, bestEffort);
+			SlicesTree::NodeId node = *i;
 
-		sumChildMergeCosts += childCosts.merge;
-		sumChildFnCosts    += childCosts.fn;
-		minChildFpCosts     = std::min(minChildFpCosts, childCosts.fp);
-	}
+			if (belowBestEffort[node])
+				continue;
 
-	NodeCosts costs;
-	costs.split = 0;
-	costs.merge = _weightMerge*(numChildren - 1) + sumChildMergeCosts;
-	costs.fn    = sumChildFnCosts;
-	costs.fp    = minChildFpCosts;
+			boost::shared_ptr<Slice> slice = slices.getSlice(node);
 
-	LOG_DEBUG(topologicallosslog) << "\tthis slice is above best-effort, assign total costs of " << costs << std::endl;
+			unsigned int numChildren = slices.getNumChildren(node);
 
-	(*_lossFunction)[slice->getId()] = costs;
+			LOG_DEBUG(topologicallosslog)
+					<< "slice " << slice->getId()
+					<< ", size = " << slice->getSize()
+					<< " is above best-effort and has " << numChildren << " children"
+					<< std::endl;
 
-	return costs;
-}
+			if (numChildren == 0) {
 
-void
-TopologicalLoss::traverseBelowBestEffort(boost::shared_ptr<SlicesTree::Node> node, NodeCosts costs) {
+				// We are above best-effort, and we don't have children -- this 
+				// slice belongs to a path that is completely spurious.
 
-	boost::shared_ptr<Slice> slice = node->getSlice();
+				// give it false positive costs
+				costs[node].split = 0;
+				costs[node].merge = 0;
+				costs[node].fp    = _weightFp;
+				costs[node].fn    = 0;
 
-	LOG_DEBUG(topologicallosslog)
-			<< "entering slice " << slice->getId()
-			<< ", size = " << slice->getComponent()->getSize()
-			<< std::endl;
+			} else {
 
-	(*_lossFunction)[slice->getId()] = costs;
+				// get our node costs from the costs of our children
+				double sumChildMergeCosts = 0;
+				double sumChildFnCosts    = 0;
+				double minChildFpCosts    = std::numeric_limits<double>::infinity();
+				for (SlicesTree::NodeId child = slices.getFirstChild(node); child != SlicesTree::NoNode; child = slices.getNextSibling(child)) {
 
-	double k = node->getChildren().size();
+					sumChildMergeCosts += costs[child].merge;
+					sumChildFnCosts    += costs[child].fn;
+					minChildFpCosts     = std::min(minChildFpCosts, costs[child].fp);
+				}
 
-	// get the children's costs
-	NodeCosts childCosts;
-	childCosts.split = costs.split + _weightSplit*(k - 1)/k;
-	childCosts.merge = 0;
-	childCosts.fn    = costs.fn/k;
-	childCosts.fp    = 0;
+				costs[node].split = 0;
+				costs[node].merge = _weightMerge*(numChildren - 1) + sumChildMergeCosts;
+				costs[node].fn    = sumChildFnCosts;
+				costs[node].fp    = minChildFpCosts;
+			}
 
-	// propagate costs downwards
-	foreach (boost::shared_ptr<SlicesTree::Node> child, node->getChildren())
-		traverseBelowBestEffort(child, childCosts);
+			LOG_DEBUG(topologicallosslog) << "\tassign total costs of " << costs[node] << std::endl;
+
+			(*_lossFunction)[slice->getId()] = costs[node];
+		}
+	}
 }
@@ -28,9 +28,10 @@ private:
 
 	void updateOutputs();
 
-	NodeCosts traverseAboveBestEffort(boost::shared_ptr<SlicesTree::Node> node, const Slices& bestEffort);
-
-	void traverseBelowBestEffort(boost::shared_ptr<SlicesTree::Node> node, NodeCosts costs);
+	/**
+	 * Assign the costs to all nodes of a tree, given its best-effort slices.
+	 */
+	void assignCosts(const SlicesTree& slices, const Slices& bestEffort);
 
 	pipeline::Inputs<SlicesTree>   _slices;
 	pipeline::Inputs<Slices>       _bestEffort;
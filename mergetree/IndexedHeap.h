@@ -0,0 +1,230 @@
+#ifndef MULTI2CUT_MERGETREE_INDEXED_HEAP_H__
+#define MULTI2CUT_MERGETREE_INDEXED_HEAP_H__
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <util/assert.h>
+
+/**
+ * An addressable d-ary min-heap of integral ids with priorities. Each id is
+ * contained at most once, and the priority of a contained id can be changed
+ * or the id removed in O(log n). Ties are broken by the id, such that the
+ * order in which elements leave the heap is deterministic.
+ *
+ * The memory for the position lookup grows with the largest id pushed.
+ */
+template <typename Priority, unsigned int Arity = 4>
+class IndexedHeap {
+
+public:
+
+	typedef unsigned int IdType;
+
+	/**
+	 * Reserve memory for ids up to maxId.
+	 */
+	void reserve(IdType maxId) {
+
+		_elements.reserve(maxId + 1);
+		if (_positions.size() <= maxId)
+			_positions.resize(maxId + 1, NotInHeap);
+	}
+
+	/**
+	 * Build the heap from a list of ids and their priorities in O(n). Any
+	 * previous content is removed.
+	 */
+	void assign(const std::vector<IdType>& ids, const std::vector<Priority>& priorities) {
+
+		clear();
+
+		_elements.reserve(ids.size());
+
+		for (unsigned int i = 0; i < ids.size(); i++) {
+
+			UTIL_ASSERT(!contains(ids[i]));
+
+			if (_positions.size() <= ids[i])
+				_positions.resize(ids[i] + 1, NotInHeap);
+
+			_positions[ids[i]] = _elements.size();
+			_elements.push_back(Element(ids[i], priorities[i]));
+		}
+
+		for (unsigned int i = _elements.size()/Arity + 1; i-- > 0;)
+			if (i < _elements.size())
+				siftDown(i);
+	}
+
+	/**
+	 * Add an id with the given priority, or change its priority if it is
+	 * already contained.
+	 */
+	void push(IdType id, Priority priority) {
+
+		if (_positions.size() <= id)
+			_positions.resize(id + 1, NotInHeap);
+
+		if (_positions[id] != NotInHeap) {
+
+			unsigned int pos = _positions[id];
+			Element old = _elements[pos];
+			_elements[pos].priority = priority;
+
+			if (less(_elements[pos], old))
+				siftUp(pos);
+			else
+				siftDown(pos);
+
+			return;
+		}
+
+		_positions[id] = _elements.size();
+		_elements.push_back(Element(id, priority));
+		siftUp(_elements.size() - 1);
+	}
+
+	/**
+	 * Remove an id from the heap, if it is contained.
+	 */
+	void erase(IdType id) {
+
+		if (!contains(id))
+			return;
+
+		unsigned int pos = _positions[id];
+		_positions[id] = NotInHeap;
+
+		Element last = _elements.back();
+		_elements.pop_back();
+
+		if (pos == _elements.size())
+			return;
+
+		Element old = _elements[pos];
+		_elements[pos] = last;
+		_positions[last.id] = pos;
+
+		if (less(last, old))
+			siftUp(pos);
+		else
+			siftDown(pos);
+	}
+
+	/**
+	 * Test whether an id is contained in the heap.
+	 */
+	bool contains(IdType id) const {
+
+		return id < _positions.size() && _positions[id] != NotInHeap;
+	}
+
+	/**
+	 * The id with the smallest priority.
+	 */
+	IdType top() const { return _elements.front().id; }
+
+	/**
+	 * The smallest priority.
+	 */
+	Priority topPriority() const { return _elements.front().priority; }
+
+	/**
+	 * Remove the id with the smallest priority.
+	 */
+	void pop() { erase(top()); }
+
+	unsigned int size() const { return _elements.size(); }
+
+	bool empty() const { return _elements.empty(); }
+
+	void clear() {
+
+		for (unsigned int i = 0; i < _elements.size(); i++)
+			_positions[_elements[i].id] = NotInHeap;
+		_elements.clear();
+	}
+
+private:
+
+	static const unsigned int NotInHeap;
+
+	struct Element {
+
+		Element(IdType id_, Priority priority_) :
+			id(id_),
+			priority(priority_) {}
+
+		IdType   id;
+		Priority priority;
+	};
+
+	static bool less(const Element& a, const Element& b) {
+
+		if (a.priority == b.priority)
+			return a.id < b.id;
+
+		return a.priority < b.priority;
+	}
+
+	void siftUp(unsigned int pos) {
+
+		Element element = _elements[pos];
+
+		while (pos > 0) {
+
+			unsigned int parent = (pos - 1)/Arity;
+
+			if (!less(element, _elements[parent]))
+				break;
+
+			_elements[pos] = _elements[parent];
+			_positions[_elements[pos].id] = pos;
+			pos = parent;
+		}
+
+		_elements[pos] = element;
+		_positions[element.id] = pos;
+	}
+
+	void siftDown(unsigned int pos) {
+
+		Element element = _elements[pos];
+		unsigned int size = _elements.size();
+
+		while (true) {
+
+			unsigned int first = pos*Arity + 1;
+			if (first >= size)
+				break;
+
+			unsigned int last = std::min(first + Arity, size);
+
+			unsigned int smallest = first;
+			for (unsigned int child = first + 1; child < last; child++)
+				if (less(_elements[child], _elements[smallest]))
+					smallest = child;
+
+			if (!less(_elements[smallest], element))
+				break;
+
+			_elements[pos] = _elements[smallest];
+			_positions[_elements[pos].id] = pos;
+			pos = smallest;
+		}
+
+		_elements[pos] = element;
+		_positions[element.id] = pos;
+	}
+
+	std::vector<Element>      _elements;
+	std::vector<unsigned int> _positions;
+};
+
+template <typename Priority, unsigned int Arity>
+const unsigned int IndexedHeap<Priority, Arity>::NotInHeap = std::numeric_limits<unsigned int>::max();
+
+#endif // MULTI2CUT_MERGETREE_INDEXED_HEAP_H__
+
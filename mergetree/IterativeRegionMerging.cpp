@@ -1,56 +1,140 @@
 #include <cassert>
 #include <util/Logger.h>
-#include <vigra/graph_algorithms.hxx>
 #include "IterativeRegionMerging.h"
 
 logger::LogChannel mergetreelog("mergetreelog", "[IterativeRegionMerging] ");
 
-namespace vigra {
+IterativeRegionMerging::IterativeRegionMerging(
+		vigra::MultiArrayView<2, int>   initialRegions,
+		vigra::MultiArrayView<2, float> intensities,
+		vigra::MultiArrayView<2, int>   mergeTree) :
+	_grid(initialRegions.shape()),
+	_gridEdgeWeights(_grid),
+	_sharedMergeTree(mergeTree),
+	_writeMergeTree(true),
+	_numLiveEdges(0),
+	_concurrentScoring(true) {
+
+	bool hasIntensities = (intensities.size() > 0);
 
-// type traits to use MultiArrayView as NodeMap
-template <>
-struct GraphMapTypeTraits<MultiArrayView<2, int> > {
-	typedef int        Value;
-	typedef int&       Reference;
-	typedef const int& ConstReference;
-};
+	if (hasIntensities)
+		UTIL_ASSERT(intensities.shape() == initialRegions.shape());
 
-} // namespace vigra
+	// an own merge-tree image is created in createMergeTree
+	if (_sharedMergeTree.hasData())
+		UTIL_ASSERT(_sharedMergeTree.shape() == initialRegions.shape()*2);
+
+	// get initial region adjecancy graph, the node ids are the region labels, 
+	// and accumulate the region statistics
+
+	for (int y = 0; y < initialRegions.height(); y++)
+		for (int x = 0; x < initialRegions.width(); x++) {
+
+			int id = initialRegions(x, y);
+
+			_rag.addNode(id);
+			_regionStatistics.addPixel(id, x, y, (hasIntensities ? intensities(x, y) : 0));
+		}
+
+	// each merge adds one node
+	_rag.reserve(2*(_rag.maxNodeId() + 1), 0);
+	_regionStatistics.reserve(2*(_rag.maxNodeId() + 1));
+
+	std::vector<std::vector<GridGraphType::Edge> > affiliatedEdges;
+
+	for (GridGraphType::EdgeIt edge(_grid); edge != lemon::INVALID; ++edge) {
+
+		int u = initialRegions[_grid.u(*edge)];
+		int v = initialRegions[_grid.v(*edge)];
+
+		if (u == v)
+			continue;
+
+		addBoundary(*edge, u, v, affiliatedEdges);
+	}
+
+	finishRag(affiliatedEdges);
+}
 
 IterativeRegionMerging::IterativeRegionMerging(
-		vigra::MultiArrayView<2, int> initialRegions) :
-	_grid(initialRegions.shape()),
-	_gridEdgeWeights(_grid),
-	_ragToGridEdges(_rag),
-	_parentNodes(_rag),
-	_edgeScores(_rag),
-	_mergeTree(initialRegions.shape()*2),
-	_mergeEdges(EdgeCompare(_edgeScores)) {
+		const RegionStatistics&          regionStatistics,
+		const std::vector<Boundary>&     boundaries,
+		const GridGraphType::shape_type& shape,
+		vigra::MultiArrayView<2, int>    mergeTree) :
+	_grid(shape),
+	_regionStatistics(regionStatistics),
+	_sharedMergeTree(mergeTree),
+	_writeMergeTree(true),
+	_numLiveEdges(0),
+	_concurrentScoring(true) {
+
+	if (_sharedMergeTree.hasData())
+		UTIL_ASSERT(_sharedMergeTree.shape() == shape*2);
+
+	// the nodes of the RAG are all regions with pixels
+	for (int id = 0; id <= _regionStatistics.maxId(); id++)
+		if (_regionStatistics.size(id) > 0)
+			_rag.addNode(id);
+
+	// each merge adds one node
+	_rag.reserve(2*(_rag.maxNodeId() + 1), 0);
+	_regionStatistics.reserve(2*(_rag.maxNodeId() + 1));
+
+	std::vector<std::vector<GridGraphType::Edge> > affiliatedEdges;
+
+	for (unsigned int i = 0; i < boundaries.size(); i++)
+		addBoundary(boundaries[i].edge, boundaries[i].u, boundaries[i].v, affiliatedEdges);
+
+	finishRag(affiliatedEdges);
+}
+
+void
+IterativeRegionMerging::addBoundary(
+		const GridGraphType::Edge&                      edge,
+		int                                             u,
+		int                                             v,
+		std::vector<std::vector<GridGraphType::Edge> >& affiliatedEdges) {
+
+	_regionStatistics.addBoundary(u, v);
 
-	// get initial region adjecancy graph
+	RagType::Edge ragEdge = _rag.findEdge(_rag.nodeFromId(u), _rag.nodeFromId(v));
+	if (ragEdge == lemon::INVALID) {
+
+		ragEdge = _rag.addEdge(_rag.nodeFromId(u), _rag.nodeFromId(v));
+		affiliatedEdges.push_back(std::vector<GridGraphType::Edge>());
+	}
 
-	RagType::EdgeMap<std::vector<GridGraphType::Edge> > affiliatedEdges;
-	vigra::makeRegionAdjacencyGraph(
-			_grid,
-			initialRegions,
-			_rag,
-			affiliatedEdges);
+	affiliatedEdges[_rag.id(ragEdge)].push_back(edge);
+}
+
+void
+IterativeRegionMerging::finishRag(std::vector<std::vector<GridGraphType::Edge> >& affiliatedEdges) {
 
 	// get grid edges for each rag edge
 
-	for (RagType::EdgeIt edge(_rag); edge != lemon::INVALID; ++edge)
-		_ragToGridEdges[*edge] = affiliatedEdges[*edge];
+	std::size_t numGridEdges = 0;
+	for (unsigned int i = 0; i < affiliatedEdges.size(); i++)
+		numGridEdges += affiliatedEdges[i].size();
+
+	_ragToGridEdges.reserve(_rag.maxEdgeId(), numGridEdges);
+	for (RagType::EdgeIt edge(_rag); edge != lemon::INVALID; ++edge) {
 
-	// prepare merge-tree image
+		_ragToGridEdges.append(
+				_rag.id(*edge),
+				affiliatedEdges[_rag.id(*edge)].begin(),
+				affiliatedEdges[_rag.id(*edge)].end());
+
+		// free the memory early
+		std::vector<GridGraphType::Edge>().swap(affiliatedEdges[_rag.id(*edge)]);
+	}
 
-	_mergeTree = 0;
+	_parentNodes.resize(_rag.maxNodeId() + 1);
+	_edgeScores.resize(_rag.maxEdgeId() + 1);
 
 	// logging
 
-	int numRegions = 0;
-	for (RagType::NodeIt node(_rag); node != lemon::INVALID; ++node)
-		numRegions++;
-	int numRegionEdges = _ragToGridEdges.size();
+	int numRegions     = _rag.nodeNum();
+	int numRegionEdges = _rag.edgeNum();
 
 	LOG_USER(mergetreelog)
 			<< "got region adjecancy graph with "
@@ -59,41 +143,65 @@ IterativeRegionMerging::IterativeRegionMerging(
 }
 
 void
-IterativeRegionMerging::finishMergeTree() {
+IterativeRegionMerging::freezeRegion(int regionId) {
 
-	LOG_USER(mergetreelog) << "finishing merge tree image..." << std::endl;
+	if (_frozen.size() <= static_cast<unsigned int>(regionId))
+		_frozen.resize(regionId + 1, false);
 
-	// get the max leaf distance for each region
+	_frozen[regionId] = true;
+}
 
-	util::cont_map<RagType::Node, int, NodeNumConverter<RagType> > leafDistances(_rag);
+std::vector<unsigned int>
+IterativeRegionMerging::mergeableEdgeIds() const {
 
-	int maxDistance = 0;
-	for (RagType::NodeIt node(_rag); node != lemon::INVALID; ++node) {
+	std::vector<unsigned int> ids;
+	ids.reserve(_rag.edgeNum());
+	for (RagType::EdgeIt edge(_rag); edge != lemon::INVALID; ++edge)
+		if (mergeable(*edge))
+			ids.push_back(_rag.id(*edge));
 
-		int distance;
-		RagType::Node parent = *node;
-		for (distance = 0; parent != lemon::INVALID; distance++, parent = _parentNodes[parent]) {
+	return ids;
+}
 
-			if (!leafDistances.count(parent))
-				leafDistances[parent] = distance;
-			else {
+int
+IterativeRegionMerging::getRoot(int regionId) const {
 
-				if (distance > leafDistances[parent])
-					leafDistances[parent] = distance;
-				else
-					break;
-			}
-		}
+	RagType::Node node = _rag.nodeFromId(regionId);
+
+	while (_parentNodes[_rag.id(node)] != lemon::INVALID)
+		node = _parentNodes[_rag.id(node)];
+
+	return _rag.id(node);
+}
 
-		maxDistance = std::max(distance, maxDistance);
+void
+IterativeRegionMerging::initLeafDistances() {
+
+	// -1 for ids that are not a node
+	_leafDistances.assign(_rag.maxNodeId() + 1, -1);
+
+	for (RagType::NodeIt node(_rag); node != lemon::INVALID; ++node) {
+
+		int distance = 0;
+		if (_rag.id(*node) < static_cast<int>(_initialLeafDistances.size()))
+			distance = _initialLeafDistances[_rag.id(*node)];
+
+		_leafDistances[_rag.id(*node)] = distance;
 	}
+}
+
+void
+IterativeRegionMerging::finishMergeTree() {
+
+	// the merge-tree image was labelled with the leaf distances during 
+	// merging already
+
+	int maxDistance = 0;
+	for (unsigned int i = 0; i < _leafDistances.size(); i++)
+		maxDistance = std::max(maxDistance, _leafDistances[i]);
 
 	// with too many merge levels we run into trouble later
 	UTIL_ASSERT_REL(maxDistance, <, 65535);
 
 	LOG_DEBUG(mergetreelog) << "max merge-tree depth is " << maxDistance << std::endl;
-
-	// replace region ids in merge tree image with leaf distance
-	for (vigra::MultiArray<2, int>::iterator i = _mergeTree.begin(); i != _mergeTree.end(); i++)
-		*i = leafDistances.at_index(*i);
 }
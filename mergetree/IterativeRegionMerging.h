@@ -3,14 +3,18 @@
 
 #include <iostream>
 #include <fstream>
+#include <limits>
+#include <vector>
 #include <util/Logger.h>
-#include <util/cont_map.hpp>
 #include <util/assert.h>
 #include <vigra/multi_gridgraph.hxx>
 #include <vigra/multi_watersheds.hxx>
-#include <vigra/adjacency_list_graph.hxx>
-#include "NodeNumConverter.h"
-#include "EdgeNumConverter.h"
+#include <parallel/ParallelFor.h>
+#include "IndexedHeap.h"
+#include "MergeHistory.h"
+#include "RegionAdjacencyGraph.h"
+#include "RegionStatistics.h"
+#include "SpliceableLists.h"
 
 extern logger::LogChannel mergetreelog;
 
@@ -18,10 +22,44 @@ class IterativeRegionMerging {
 
 public:
 
-	typedef vigra::GridGraph<2>       GridGraphType;
-	typedef vigra::AdjacencyListGraph RagType;
+	typedef vigra::GridGraph<2>  GridGraphType;
+	typedef RegionAdjacencyGraph RagType;
 
-	IterativeRegionMerging(vigra::MultiArrayView<2, int> initialRegions);
+	/**
+	 * A grid edge on the boundary between the regions u and v.
+	 */
+	struct Boundary {
+
+		GridGraphType::Edge edge;
+		int                 u;
+		int                 v;
+	};
+
+	/**
+	 * Create a new region merging for the given initial regions. If 
+	 * intensities are given, their sums per region are part of the region 
+	 * statistics.
+	 *
+	 * If mergeTree is given, the merge tree is written to it instead of an 
+	 * own image. It has to be twice the size of the initial regions, and 
+	 * labels are combined with the values present in it by their maximum.
+	 */
+	IterativeRegionMerging(
+			vigra::MultiArrayView<2, int>   initialRegions,
+			vigra::MultiArrayView<2, float> intensities = vigra::MultiArrayView<2, float>(),
+			vigra::MultiArrayView<2, int>   mergeTree = vigra::MultiArrayView<2, int>());
+
+	/**
+	 * Create a new region merging for regions that are only given by their 
+	 * statistics and the grid edges on the boundaries between them, e.g., 
+	 * the regions left after merging in parts of an image of the given shape. 
+	 * If mergeTree is given, it is used as for the constructor above.
+	 */
+	IterativeRegionMerging(
+			const RegionStatistics&       regionStatistics,
+			const std::vector<Boundary>&  boundaries,
+			const GridGraphType::shape_type& shape,
+			vigra::MultiArrayView<2, int> mergeTree = vigra::MultiArrayView<2, int>());
 
 	/**
 	 * Store the initial (before calling createMergeTree) or final RAG.
@@ -29,44 +67,102 @@ public:
 	template <typename ScoringFunction>
 	void storeRag(std::string filename, ScoringFunction& scoringFunction);
 
+	/**
+	 * Exclude a region from merging. Edges to frozen regions are neither 
+	 * scored nor merged. Call this before createMergeTree.
+	 */
+	void freezeRegion(int regionId);
+
+	/**
+	 * Set the leaf distance of the initial regions, in case they are the 
+	 * result of previous merges. The leaf distances of all regions in the 
+	 * merge tree start counting from these values.
+	 */
+	void setInitialLeafDistances(const std::vector<int>& leafDistances) { _initialLeafDistances = leafDistances; }
+
+	/**
+	 * Do not write a merge-tree image, e.g., if only the merges are needed. 
+	 * Call this before createMergeTree.
+	 */
+	void skipMergeTree() { _writeMergeTree = false; }
+
+	/**
+	 * Allow or forbid to score edges concurrently, even if the scoring 
+	 * function supports it. Forbid it if this object is used in a parallel 
+	 * loop already. Allowed by default.
+	 */
+	void setConcurrentScoring(bool concurrentScoring) { _concurrentScoring = concurrentScoring; }
+
+	/**
+	 * Score all mergeable edges of the initial RAG without merging. This lets 
+	 * a scoring function cache its per-edge state once, before it is copied 
+	 * for several merge trees on copies of this object.
+	 */
 	template <typename ScoringFunction>
-	void createMergeTree(ScoringFunction& scoringFunction);
+	void prepareScoringFunction(ScoringFunction& scoringFunction);
+
+	/**
+	 * Merge regions in the order given by the scoring function, until all 
+	 * regions are merged or the next score would exceed maxScore.
+	 */
+	template <typename ScoringFunction>
+	void createMergeTree(
+			ScoringFunction& scoringFunction,
+			float maxScore = std::numeric_limits<float>::max());
 
 	/**
 	 * Get the final merge tree as an edge image. Thresholding this image 
-	 * reveals the merges.
+	 * reveals the merges. Empty if skipMergeTree was called.
 	 */
-	vigra::MultiArrayView<2, int> getMergeTree() { return _mergeTree; }
+	vigra::MultiArrayView<2, int> getMergeTree() {
+
+		if (_sharedMergeTree.hasData())
+			return _sharedMergeTree;
+
+		return _mergeTree;
+	}
 
 	/**
 	 * Get the region adjacency graph.
 	 */
 	RagType& getRag() { return _rag; }
 
-private:
+	/**
+	 * Get the statistics of all regions. The statistics of merged regions are 
+	 * available to the scoring function from the call to onMerge on.
+	 */
+	const RegionStatistics& getRegionStatistics() const { return _regionStatistics; }
 
-	typedef util::cont_map<RagType::Edge, std::vector<GridGraphType::Edge>, EdgeNumConverter<RagType> > GridEdgesType;
-	typedef util::cont_map<RagType::Node, RagType::Node, NodeNumConverter<RagType> >                    ParentNodesType;
-	typedef util::cont_map<RagType::Edge, float, EdgeNumConverter<RagType> >                            EdgeScoresType;
+	/**
+	 * Get the id of the largest region that contains the given region.
+	 */
+	int getRoot(int regionId) const;
 
-	struct EdgeCompare {
+	/**
+	 * Get the maximal distance of a region to the leaves of the merge tree. 
+	 * Available after createMergeTree.
+	 */
+	int getLeafDistance(int regionId) const { return _leafDistances[regionId]; }
 
-		EdgeCompare(const EdgeScoresType& edgeScores_) :
-			edgeScores(edgeScores_) {}
+	/**
+	 * Get the merges performed by createMergeTree, in the order they were 
+	 * performed.
+	 */
+	const MergeHistory::MergesType& getMerges() const { return _merges; }
 
-		bool operator()(const RagType::Edge& a, const RagType::Edge& b) {
+private:
 
-			UTIL_ASSERT(edgeScores.count(a));
-			UTIL_ASSERT(edgeScores.count(b));
+	// the parent of each region in the merge tree, indexed by node id
+	typedef std::vector<RagType::Node> ParentNodesType;
 
-			// sort edges in increasing score value
-			return edgeScores[a] > edgeScores[b];
-		}
+	// the score of each edge, indexed by edge id
+	typedef std::vector<float> EdgeScoresType;
 
-		const EdgeScoresType& edgeScores;
-	};
+	// the grid edges along the boundary of each RAG edge, keyed by RAG edge id
+	typedef SpliceableLists<GridGraphType::Edge> GridEdgesType;
 
-	typedef std::priority_queue<RagType::Edge, std::vector<RagType::Edge>, EdgeCompare> MergeEdgesType;
+	// the edges to merge, keyed by their RAG edge id
+	typedef IndexedHeap<float> MergeEdgesType;
 
 	// merge two regions and return new region node
 	template <typename ScoringFunction>
@@ -87,10 +183,78 @@ private:
 	template <typename ScoringFunction>
 	void scoreEdge(const RagType::Edge& edge, ScoringFunction& scoringFunction);
 
+	// score all edges of the initial RAG and fill the merge heap
+	template <typename ScoringFunction>
+	void scoreInitialEdges(ScoringFunction& scoringFunction);
+
+	// the ids of all mergeable edges of the RAG
+	std::vector<unsigned int> mergeableEdgeIds() const;
+
+	// score the given edges, concurrently if the scoring function allows it
+	template <typename ScoringFunction>
+	void scoreEdges(
+			const std::vector<unsigned int>& ids,
+			std::vector<float>&              scores,
+			ScoringFunction&                 scoringFunction);
+
+	// scores a list of edges, used as functor for parallelFor
+	template <typename ScoringFunction>
+	class EdgeScorer {
+
+	public:
+
+		EdgeScorer(
+				const RagType&                   rag,
+				const GridEdgesType&             ragToGridEdges,
+				const std::vector<unsigned int>& ids,
+				std::vector<float>&              scores,
+				ScoringFunction&                 scoringFunction) :
+			_rag(rag),
+			_ragToGridEdges(ragToGridEdges),
+			_ids(ids),
+			_scores(scores),
+			_scoringFunction(scoringFunction) {}
+
+		void operator()(unsigned int i) const {
+
+			_scores[i] = _scoringFunction(_rag.edgeFromId(_ids[i]), _ragToGridEdges[_ids[i]]);
+		}
+
+	private:
+
+		const RagType&                   _rag;
+		const GridEdgesType&             _ragToGridEdges;
+		const std::vector<unsigned int>& _ids;
+		std::vector<float>&              _scores;
+		ScoringFunction&                 _scoringFunction;
+	};
+
 	inline RagType::Edge nextMergeEdge() { float _; return nextMergeEdge(_); }
 	inline RagType::Edge nextMergeEdge(float& score);
 
-	inline void labelEdge(const std::vector<GridGraphType::Edge>& edge, unsigned int label);
+	// add a grid edge between regions u and v to the RAG, collecting the grid 
+	// edges of each RAG edge in affiliatedEdges
+	void addBoundary(
+			const GridGraphType::Edge&                      edge,
+			int                                             u,
+			int                                             v,
+			std::vector<std::vector<GridGraphType::Edge> >& affiliatedEdges);
+
+	// move the affiliated edges to _ragToGridEdges and prepare for merging
+	void finishRag(std::vector<std::vector<GridGraphType::Edge> >& affiliatedEdges);
+
+	// set the leaf distances of all initial regions
+	void initLeafDistances();
+
+	inline void labelEdge(const GridEdgesType::List& edge, int label);
+
+	// set a value of the merge-tree image, or keep the larger one if combine 
+	// is set
+	static void setLabel(int& value, int label, bool combine) { value = (combine ? std::max(value, label) : label); }
+
+	// test whether an edge can be merged, i.e., does not connect to a frozen 
+	// region
+	inline bool mergeable(const RagType::Edge& edge) const;
 
 	void finishMergeTree();
 
@@ -99,13 +263,35 @@ private:
 
 	RagType _rag;
 
+	RegionStatistics _regionStatistics;
+
 	GridEdgesType   _ragToGridEdges;
 	ParentNodesType _parentNodes;
 	EdgeScoresType  _edgeScores;
 
-	vigra::MultiArray<2, int> _mergeTree;
+	// the merge-tree image, unless a shared one is given
+	vigra::MultiArray<2, int>     _mergeTree;
+	vigra::MultiArrayView<2, int> _sharedMergeTree;
+
+	// whether to label the merges in the merge-tree image
+	bool _writeMergeTree;
 
 	MergeEdgesType _mergeEdges;
+
+	// the number of mergeable edges between unmerged regions, should equal 
+	// the size of _mergeEdges
+	unsigned int _numLiveEdges;
+
+	// initial regions that are excluded from merging, indexed by node id
+	std::vector<char> _frozen;
+
+	std::vector<int> _initialLeafDistances;
+	std::vector<int> _leafDistances;
+
+	MergeHistory::MergesType _merges;
+
+	// whether edges can be scored in parallel
+	bool _concurrentScoring;
 };
 
 template <typename ScoringFunction>
@@ -119,44 +305,70 @@ IterativeRegionMerging::storeRag(std::string filename, ScoringFunction& scoringF
 		unsigned int u = _rag.id(_rag.u(*edge));
 		unsigned int v = _rag.id(_rag.v(*edge));
 
-		file << u << "\t" << v << "\t" << scoringFunction(*edge, _ragToGridEdges[*edge]) << std::endl;
+		file << u << "\t" << v << "\t" << scoringFunction(*edge, _ragToGridEdges[_rag.id(*edge)]) << std::endl;
 	}
 }
 
 template <typename ScoringFunction>
 void
-IterativeRegionMerging::createMergeTree(ScoringFunction& scoringFunction) {
+IterativeRegionMerging::createMergeTree(ScoringFunction& scoringFunction, float maxScore) {
+
+	initLeafDistances();
+
+	if (_writeMergeTree && !_sharedMergeTree.hasData() && !_mergeTree.hasData())
+		_mergeTree.reshape(_grid.shape()*2, 0);
 
 	LOG_USER(mergetreelog) << "computing initial edge scores..." << std::endl;
 
 	// compute initial edge scores
-	for (RagType::EdgeIt edge(_rag); edge != lemon::INVALID; ++edge)
-		scoreEdge(*edge, scoringFunction);
+	scoreInitialEdges(scoringFunction);
+
+	_numLiveEdges = _mergeEdges.size();
 
 	LOG_USER(mergetreelog) << "merging regions..." << std::endl;
 
 	RagType::Edge next;
 	float         score;
+	unsigned int  maxHeapSize = _mergeEdges.size();
 
 	while (true) {
 
 		next = nextMergeEdge(score);
-		if (next == lemon::INVALID)
+		if (next == lemon::INVALID || score > maxScore)
 			break;
 
+		MergeHistory::Merge merge;
+		merge.a     = _rag.id(_rag.u(next));
+		merge.b     = _rag.id(_rag.v(next));
+		merge.score = score;
+
 		RagType::Node merged = mergeRegions(next, scoringFunction);
 
+		merge.parent = _rag.id(merged);
+		_merges.push_back(merge);
+
 		LOG_ALL(mergetreelog)
 				<< "merged regions " << _rag.id(_rag.u(next)) << " and " << _rag.id(_rag.v(next))
 				<< " with score " << score
 				<< " into " << _rag.id(merged) << std::endl;
+
+		LOG_ALL(mergetreelog)
+				<< "merge heap contains " << _mergeEdges.size()
+				<< " edges, " << _numLiveEdges << " edges are live" << std::endl;
+
+		UTIL_ASSERT_REL(_mergeEdges.size(), ==, _numLiveEdges);
+
+		maxHeapSize = std::max(maxHeapSize, _mergeEdges.size());
 	}
 
 	LOG_USER(mergetreelog) << "finished merging" << std::endl;
+	LOG_DEBUG(mergetreelog)
+			<< "merge heap contained at most " << maxHeapSize
+			<< " edges, " << _mergeEdges.size() << " edges are left" << std::endl;
 	LOG_DEBUG(mergetreelog)
 			<< "_ragToGridEdges contains "
-			<< _ragToGridEdges.size() << " elements, with an overhead of "
-			<< _ragToGridEdges.overhead() << std::endl;
+			<< _ragToGridEdges.numValues() << " grid edges in "
+			<< _ragToGridEdges.numSegments() << " segments" << std::endl;
 
 	finishMergeTree();
 }
@@ -169,8 +381,8 @@ IterativeRegionMerging::mergeRegions(
 		ScoringFunction& scoringFunction) {
 
 	// don't merge previously merged nodes
-	UTIL_ASSERT(_parentNodes[a] == lemon::INVALID);
-	UTIL_ASSERT(_parentNodes[b] == lemon::INVALID);
+	UTIL_ASSERT(_parentNodes[_rag.id(a)] == lemon::INVALID);
+	UTIL_ASSERT(_parentNodes[_rag.id(b)] == lemon::INVALID);
 
 	RagType::Edge edge = _rag.findEdge(a, b);
 
@@ -195,17 +407,31 @@ IterativeRegionMerging::mergeRegions(
 	}
 
 	// don't merge previously merged nodes
-	UTIL_ASSERT(_parentNodes[a] == lemon::INVALID);
-	UTIL_ASSERT(_parentNodes[b] == lemon::INVALID);
+	UTIL_ASSERT(_parentNodes[_rag.id(a)] == lemon::INVALID);
+	UTIL_ASSERT(_parentNodes[_rag.id(b)] == lemon::INVALID);
 
 	// add new c = a + b
 	RagType::Node c = _rag.addNode();
+	_parentNodes.resize(_rag.maxNodeId() + 1);
+
+	_regionStatistics.merge(_rag.id(a), _rag.id(b), _rag.id(c), _ragToGridEdges[_rag.id(edge)].size());
+
+	// the children of c are complete, such that its leaf distance is final
+	_leafDistances.resize(_rag.maxNodeId() + 1, -1);
+	_leafDistances[_rag.id(c)] = std::max(_leafDistances[_rag.id(a)], _leafDistances[_rag.id(b)]) + 1;
+
+	// label the edge pixels between a and b with the leaf distance of c
+	labelEdge(_ragToGridEdges[_rag.id(edge)], _leafDistances[_rag.id(c)]);
 
-	// label the edge pixels between a and b with c
-	labelEdge(_ragToGridEdges[edge], _rag.id(c));
+	_parentNodes[_rag.id(a)] = c;
+	_parentNodes[_rag.id(b)] = c;
 
-	_parentNodes[a] = c;
-	_parentNodes[b] = c;
+	// the edge between a and b is not live anymore
+	if (_mergeEdges.contains(_rag.id(edge))) {
+
+		_mergeEdges.erase(_rag.id(edge));
+		_numLiveEdges--;
+	}
 
 	// connect c to neighbors of a and b and set affiliated edges accordingly
 
@@ -225,11 +451,20 @@ IterativeRegionMerging::mergeRegions(
 			// get the neighbor
 			RagType::Node neighbor = (_rag.u(*edge) == child ? _rag.v(*edge) : _rag.u(*edge));
 
-			// don't consider the node we currently merge with, and all 
-			// previously merged nodes
-			if (neighbor == other || _parentNodes[neighbor] != lemon::INVALID)
+			// don't consider the node we currently merge with, previously 
+			// merged nodes are detached already
+			if (neighbor == other)
 				continue;
 
+			UTIL_ASSERT(_parentNodes[_rag.id(neighbor)] == lemon::INVALID);
+
+			// the edge to child is replaced by an edge to c
+			if (_mergeEdges.contains(_rag.id(*edge))) {
+
+				_mergeEdges.erase(_rag.id(*edge));
+				_numLiveEdges--;
+			}
+
 			neighbors.push_back(neighbor);
 			neighborEdges.push_back(*edge);
 		}
@@ -240,25 +475,31 @@ IterativeRegionMerging::mergeRegions(
 			const RagType::Node neighbor     = neighbors[i];
 			const RagType::Edge neighborEdge = neighborEdges[i];
 
-			// add the edge from c->neighbor
+			// add the edge from c->neighbor, if it does not exist yet (the
+			// neighbor might be adjacent to a and b)
 			RagType::Edge newEdge = _rag.findEdge(c, neighbor);
-			if (newEdge == lemon::INVALID)
+			if (newEdge == lemon::INVALID) {
+
 				newEdge = _rag.addEdge(c, neighbor);
 
-			// add affiliated edges from child->neighbor to new edge c->neighbor
-			std::copy(
-					_ragToGridEdges[neighborEdge].begin(),
-					_ragToGridEdges[neighborEdge].end(),
-					std::back_inserter(_ragToGridEdges[newEdge]));
+				if (mergeable(newEdge)) {
 
-			// clear the affiliated edges to save memory -- they are not needed 
-			// anymore
-			_ragToGridEdges[neighborEdge].clear();
+					newEdges.push_back(newEdge);
+					_numLiveEdges++;
+				}
+			}
 
-			newEdges.push_back(newEdge);
+			// move affiliated edges from child->neighbor to new edge 
+			// c->neighbor, this does not copy the grid edges
+			_ragToGridEdges.splice(_rag.id(newEdge), _rag.id(neighborEdge));
+			scoringFunction.onBoundaryMerge(newEdge, neighborEdge);
 		}
 	}
 
+	// a and b are not adjacent to their neighbors anymore
+	_rag.detach(a);
+	_rag.detach(b);
+
 	// inform visitor
 	scoringFunction.onMerge(edge, c);
 
@@ -273,37 +514,102 @@ template <typename ScoringFunction>
 void
 IterativeRegionMerging::scoreEdge(const RagType::Edge& edge, ScoringFunction& scoringFunction) {
 
-	_edgeScores[edge] = scoringFunction(edge, _ragToGridEdges[edge]);
-	_mergeEdges.push(edge);
+	float score = scoringFunction(edge, _ragToGridEdges[_rag.id(edge)]);
+
+	if (_edgeScores.size() <= static_cast<unsigned int>(_rag.id(edge)))
+		_edgeScores.resize(_rag.id(edge) + 1);
+
+	_edgeScores[_rag.id(edge)] = score;
+	_mergeEdges.push(_rag.id(edge), score);
 }
 
-IterativeRegionMerging::RagType::Edge
-IterativeRegionMerging::nextMergeEdge(float& score) {
+template <typename ScoringFunction>
+void
+IterativeRegionMerging::prepareScoringFunction(ScoringFunction& scoringFunction) {
 
-	RagType::Edge next;
+	std::vector<unsigned int> ids = mergeableEdgeIds();
+	std::vector<float>        scores(ids.size());
 
-	while (true) {
+	scoreEdges(ids, scores, scoringFunction);
+}
+
+template <typename ScoringFunction>
+void
+IterativeRegionMerging::scoreEdges(
+		const std::vector<unsigned int>& ids,
+		std::vector<float>&              scores,
+		ScoringFunction&                 scoringFunction) {
+
+	EdgeScorer<ScoringFunction> scorer(_rag, _ragToGridEdges, ids, scores, scoringFunction);
 
-		// no more edges
-		if (_mergeEdges.size() == 0)
-			return RagType::Edge();
+	if (_concurrentScoring && scoringFunction.concurrentScoring()) {
 
-		next = _mergeEdges.top(); _mergeEdges.pop();
+		LOG_DEBUG(mergetreelog)
+				<< "scoring " << ids.size() << " edges with "
+				<< parallel::getNumThreads() << " threads" << std::endl;
 
-		// don't accept edges to already merged regions
-		if (_parentNodes[_rag.u(next)] != lemon::INVALID || _parentNodes[_rag.v(next)] != lemon::INVALID)
-			continue;
+		parallel::parallelFor(0, ids.size(), scorer, 256);
 
-		break;
+	} else {
+
+		for (unsigned int i = 0; i < ids.size(); i++)
+			scorer(i);
 	}
+}
+
+template <typename ScoringFunction>
+void
+IterativeRegionMerging::scoreInitialEdges(ScoringFunction& scoringFunction) {
+
+	std::vector<unsigned int> ids = mergeableEdgeIds();
+	std::vector<float>        scores(ids.size());
+
+	scoreEdges(ids, scores, scoringFunction);
+
+	_edgeScores.resize(_rag.maxEdgeId() + 1);
+	for (unsigned int i = 0; i < ids.size(); i++)
+		_edgeScores[ids[i]] = scores[i];
 
-	score = _edgeScores[next];
+	// build the heap at once
+	_mergeEdges.reserve(_rag.maxEdgeId());
+	_mergeEdges.assign(ids, scores);
+}
+
+IterativeRegionMerging::RagType::Edge
+IterativeRegionMerging::nextMergeEdge(float& score) {
+
+	// no more edges
+	if (_mergeEdges.empty())
+		return RagType::Edge();
+
+	// the edge will be removed from the heap in mergeRegions()
+	RagType::Edge next = _rag.edgeFromId(_mergeEdges.top());
+
+	// edges to merged regions are removed from the heap eagerly
+	UTIL_ASSERT(_parentNodes[_rag.id(_rag.u(next))] == lemon::INVALID);
+	UTIL_ASSERT(_parentNodes[_rag.id(_rag.v(next))] == lemon::INVALID);
+
+	score = _edgeScores[_rag.id(next)];
 
 	return next;
 }
 
+bool
+IterativeRegionMerging::mergeable(const RagType::Edge& edge) const {
+
+	if (_frozen.empty())
+		return true;
+
+	unsigned int u = _rag.id(_rag.u(edge));
+	unsigned int v = _rag.id(_rag.v(edge));
+
+	return
+			(u >= _frozen.size() || !_frozen[u]) &&
+			(v >= _frozen.size() || !_frozen[v]);
+}
+
 void
-IterativeRegionMerging::labelEdge(const std::vector<GridGraphType::Edge>& edge, unsigned int label) {
+IterativeRegionMerging::labelEdge(const GridEdgesType::List& edge, int label) {
 
 	// label an edge (u,v) with l, such that
 	//
@@ -317,26 +623,34 @@ IterativeRegionMerging::labelEdge(const std::vector<GridGraphType::Edge>& edge,
 	//   u l v
 	//   0 l 0
 
-	for (std::vector<GridGraphType::Edge>::const_iterator i = edge.begin(); i != edge.end(); i++) {
+	if (!_writeMergeTree)
+		return;
+
+	vigra::MultiArrayView<2, int> mergeTree = getMergeTree();
+
+	// keep the larger label in a shared merge-tree image
+	bool combine = _sharedMergeTree.hasData();
+
+	for (GridEdgesType::const_iterator i = edge.begin(); i != edge.end(); i++) {
 
 		GridGraphType::Node u = _grid.u(*i);
 		GridGraphType::Node v = _grid.v(*i);
 
 		GridGraphType::Node center = u+v;
 
-		_mergeTree[center] = label;
+		setLabel(mergeTree[center], label, combine);
 
 		// x equal, vertical
 		if (u[0] == v[0]) {
 
-			_mergeTree[center + GridGraphType::Node(1, 0)] = label;
-			_mergeTree[center - GridGraphType::Node(1, 0)] = label;
+			setLabel(mergeTree[center + GridGraphType::Node(1, 0)], label, combine);
+			setLabel(mergeTree[center - GridGraphType::Node(1, 0)], label, combine);
 
 		// y equal, horizontal
 		} else if (u[1] == v[1]) {
 
-			_mergeTree[center + GridGraphType::Node(0, 1)] = label;
-			_mergeTree[center - GridGraphType::Node(0, 1)] = label;
+			setLabel(mergeTree[center + GridGraphType::Node(0, 1)], label, combine);
+			setLabel(mergeTree[center - GridGraphType::Node(0, 1)], label, combine);
 
 		}
 	}
@@ -0,0 +1,11 @@
+#include "MedianEdgeIntensity.h"
+
+util::ProgramOption optionEdgeIntensityQuantile(
+		util::_long_name        = "edgeIntensityQuantile",
+		util::_description_text = "The quantile of the edge intensities to use as score for an edge between two regions. Default is 0.5 (the median).",
+		util::_default_value    = 0.5);
+
+util::ProgramOption optionEdgeIntensityBins(
+		util::_long_name        = "edgeIntensityBins",
+		util::_description_text = "The number of bins of the histograms that summarize the intensities along region boundaries. If set, the quantiles are interpolated from these histograms, which avoids revisiting the pixels of merged boundaries, but changes the scores slightly. Default is 0, which computes exact quantiles from the pixels.",
+		util::_default_value    = 0);
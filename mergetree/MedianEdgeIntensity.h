@@ -1,41 +1,62 @@
 #ifndef MULTI2CUT_MERGETREE_MEDIAN_EDGE_INTENSITY_H__
 #define MULTI2CUT_MERGETREE_MEDIAN_EDGE_INTENSITY_H__
 
-#include <util/cont_map.hpp>
+#include <util/ProgramOptions.h>
+#include <util/assert.h>
 #include <vigra/graph_algorithms.hxx>
-#include "EdgeNumConverter.h"
 #include "ScoringFunction.h"
 
+extern util::ProgramOption optionEdgeIntensityQuantile;
+extern util::ProgramOption optionEdgeIntensityBins;
+
 /**
- * An edge scoring function that returns the median intensity of the edge 
- * pixels.
+ * An edge scoring function that returns the median (or another quantile, see 
+ * optionEdgeIntensityQuantile) intensity of the edge pixels.
+ *
+ * If optionEdgeIntensityBins is not zero (the default is zero), the intensities of each boundary are 
+ * summarized in a histogram with that many bins over the range of all 
+ * intensities. The histograms of merged boundaries are added, such that the 
+ * quantile of a merged boundary is found without visiting its pixels again. 
+ * The returned quantile is linearly interpolated inside its bin. Otherwise, the 
+ * exact quantile is computed from the pixels of the boundary.
+ *
+ * The score of each edge is cached until its boundary changes through a 
+ * merge, such that copies made after scoring all edges once (see 
+ * IterativeRegionMerging::prepareScoringFunction) do not compute the initial 
+ * scores again.
+ *
+ * Edges that existed when this scoring function was created can be scored 
+ * concurrently.
  */
 class MedianEdgeIntensity : public ScoringFunction {
 
 public:
 
-	typedef vigra::GridGraph<2>       GridGraphType;
-	typedef vigra::AdjacencyListGraph RagType;
+	typedef vigra::GridGraph<2>  GridGraphType;
+	typedef RegionAdjacencyGraph RagType;
 
 	typedef GridGraphType::EdgeMap<float> EdgeWeightsType;
 
-	struct EdgeComp {
-
-		EdgeComp(const EdgeWeightsType& weights_)
-			: weights(weights_) {}
-
-		bool operator()(
-				const GridGraphType::Edge& a,
-				const GridGraphType::Edge& b) const {
-			return weights[a] < weights[b];
-		}
-
-		const EdgeWeightsType& weights;
-	};
+	typedef std::vector<unsigned int>  HistogramType;
+	typedef std::vector<HistogramType> HistogramsType;
 
-	MedianEdgeIntensity(const vigra::MultiArrayView<2, float> intensities) :
+	MedianEdgeIntensity(
+			RagType&                              rag,
+			const vigra::MultiArrayView<2, float> intensities) :
 		_grid(intensities.shape()),
-		_edgeWeights(_grid) {
+		_edgeWeights(_grid),
+		_minEdgeWeight(0),
+		_maxEdgeWeight(0),
+		_binWidth(0),
+		_rag(rag),
+		_histograms(rag.maxEdgeId() + 1),
+		_scores(rag.maxEdgeId() + 1),
+		_hasScore(rag.maxEdgeId() + 1, false),
+		_quantile(optionEdgeIntensityQuantile),
+		_numBins(optionEdgeIntensityBins) {
+
+		UTIL_ASSERT_REL(_quantile, >=, 0);
+		UTIL_ASSERT_REL(_quantile, <=, 1);
 
 		vigra::edgeWeightsFromNodeWeights(
 				_grid,
@@ -44,29 +65,212 @@ public:
 
 		if (_edgeWeights.size() == 0)
 			return;
+		_minEdgeWeight = *_edgeWeights.begin();
 		_maxEdgeWeight = *_edgeWeights.begin();
-		for (EdgeWeightsType::const_iterator i = _edgeWeights.begin(); i != _edgeWeights.end(); i++)
+		for (EdgeWeightsType::const_iterator i = _edgeWeights.begin(); i != _edgeWeights.end(); i++) {
+			_minEdgeWeight = std::min(_minEdgeWeight, *i);
 			_maxEdgeWeight = std::max(_maxEdgeWeight, *i);
+		}
+
+		_binWidth = (_maxEdgeWeight - _minEdgeWeight)/std::max(_numBins, 1);
 	}
 
+	/**
+	 * Create a copy of another MedianEdgeIntensity for a copy of its RAG. The 
+	 * edge weights and the histograms found so far are copied.
+	 */
+	MedianEdgeIntensity(
+			RagType&                   rag,
+			const MedianEdgeIntensity& other) :
+		_grid(other._grid),
+		_edgeWeights(other._edgeWeights),
+		_minEdgeWeight(other._minEdgeWeight),
+		_maxEdgeWeight(other._maxEdgeWeight),
+		_binWidth(other._binWidth),
+		_rag(rag),
+		_histograms(other._histograms),
+		_scores(other._scores),
+		_hasScore(other._hasScore),
+		_quantile(other._quantile),
+		_numBins(other._numBins) {}
+
 	/**
 	 * Get the score for an edge. An edge will be merged the earlier, the 
 	 * smaller its score is.
 	 */
-	float operator()(const RagType::Edge& edge, std::vector<GridGraphType::Edge>& gridEdges) {
+	float operator()(const RagType::Edge& edge, const GridEdgesType& gridEdges) {
+
+		if (gridEdges.empty())
+			return 0;
+
+		unsigned int id = _rag.id(edge);
+
+		// new edges are only scored between merges, never concurrently
+		if (id >= _scores.size()) {
+
+			_scores.resize(id + 1);
+			_hasScore.resize(id + 1, false);
+		}
+
+		if (!_hasScore[id]) {
+
+			_scores[id]   = computeScore(edge, gridEdges);
+			_hasScore[id] = true;
+		}
+
+		return _scores[id];
+	}
+
+	/**
+	 * Add the histogram of the boundary of edge source to the one of edge 
+	 * target. The histogram of source is released.
+	 */
+	void onBoundaryMerge(const RagType::Edge& target, const RagType::Edge& source) {
+
+		// the boundary of target changed
+		invalidateScore(target);
+
+		if (_numBins == 0)
+			return;
+
+		// create both entries before taking references
+		getHistogram(target);
+		getHistogram(source);
+
+		HistogramType& sourceHistogram = getHistogram(source);
+		HistogramType& targetHistogram = getHistogram(target);
+
+		if (sourceHistogram.empty())
+			return;
 
-		std::vector<GridGraphType::Edge>::iterator median = gridEdges.begin() + gridEdges.size()/2;
-		std::nth_element(gridEdges.begin(), median, gridEdges.end(), EdgeComp(_edgeWeights));
+		if (targetHistogram.empty())
+			targetHistogram.swap(sourceHistogram);
+		else
+			for (int i = 0; i < _numBins; i++)
+				targetHistogram[i] += sourceHistogram[i];
 
-		return _edgeWeights[*median];
+		HistogramType().swap(sourceHistogram);
 	}
 
+	/**
+	 * Edges can be scored concurrently, as long as no merge happens.
+	 */
+	bool concurrentScoring() const { return true; }
+
 private:
 
+	float computeScore(const RagType::Edge& edge, const GridEdgesType& gridEdges) {
+
+		// the rank of the quantile in the sorted edge weights
+		unsigned int rank = std::min(
+				static_cast<unsigned int>(_quantile*gridEdges.size()),
+				gridEdges.size() - 1);
+
+		if (_numBins == 0)
+			return exactQuantile(gridEdges, rank);
+
+		HistogramType& histogram = getHistogram(edge);
+
+		// build the histogram for edges that did not get one through merges
+		if (histogramSize(histogram) != gridEdges.size())
+			fillHistogram(histogram, gridEdges);
+
+		return histogramQuantile(histogram, rank);
+	}
+
+	void invalidateScore(const RagType::Edge& edge) {
+
+		unsigned int id = _rag.id(edge);
+
+		if (id < _hasScore.size())
+			_hasScore[id] = false;
+	}
+
+	float exactQuantile(const GridEdgesType& gridEdges, unsigned int rank) const {
+
+		// the boundary is not random-access, collect its weights
+		std::vector<float> weights;
+		weights.reserve(gridEdges.size());
+		for (GridEdgesType::const_iterator i = gridEdges.begin(); i != gridEdges.end(); i++)
+			weights.push_back(_edgeWeights[*i]);
+
+		std::vector<float>::iterator quantile = weights.begin() + rank;
+		std::nth_element(weights.begin(), quantile, weights.end());
+
+		return *quantile;
+	}
+
+	// get the histogram of an edge, resize the histograms for new edges
+	HistogramType& getHistogram(const RagType::Edge& edge) {
+
+		unsigned int id = _rag.id(edge);
+
+		if (id >= _histograms.size())
+			_histograms.resize(id + 1);
+
+		return _histograms[id];
+	}
+
+	void fillHistogram(HistogramType& histogram, const GridEdgesType& gridEdges) {
+
+		histogram.assign(_numBins, 0);
+
+		for (GridEdgesType::const_iterator i = gridEdges.begin(); i != gridEdges.end(); i++)
+			histogram[bin(_edgeWeights[*i])]++;
+	}
+
+	float histogramQuantile(const HistogramType& histogram, unsigned int rank) const {
+
+		unsigned int below = 0;
+		int i = 0;
+		for (; i < _numBins - 1; i++) {
+
+			if (below + histogram[i] > rank)
+				break;
+
+			below += histogram[i];
+		}
+
+		// interpolate between the bin boundaries
+		float fraction = (rank - below + 0.5)/histogram[i];
+
+		return _minEdgeWeight + (i + fraction)*_binWidth;
+	}
+
+	unsigned int histogramSize(const HistogramType& histogram) const {
+
+		unsigned int size = 0;
+		for (unsigned int i = 0; i < histogram.size(); i++)
+			size += histogram[i];
+
+		return size;
+	}
+
+	int bin(float weight) const {
+
+		if (_binWidth == 0)
+			return 0;
+
+		return std::min(static_cast<int>((weight - _minEdgeWeight)/_binWidth), _numBins - 1);
+	}
+
 	GridGraphType   _grid;
 	EdgeWeightsType _edgeWeights;
+	float           _minEdgeWeight;
 	float           _maxEdgeWeight;
+	float           _binWidth;
+
+	RagType& _rag;
+
+	// the histogram of edge weights for each boundary, indexed by edge id
+	HistogramsType _histograms;
+
+	// the cached score of each edge, indexed by edge id
+	std::vector<float> _scores;
+	std::vector<char>  _hasScore;
+
+	float _quantile;
+	int   _numBins;
 };
 
 #endif // MULTI2CUT_MERGETREE_MEDIAN_EDGE_INTENSITY_H__
-
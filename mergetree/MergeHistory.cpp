@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <fstream>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <util/exceptions.h>
+#include "MergeHistory.h"
+
+namespace {
+
+const char Magic[4] = { 'M', 'T', 'H', '1' };
+
+// merges are read and written as a whole
+BOOST_STATIC_ASSERT(sizeof(MergeHistory::Merge) == 16);
+BOOST_STATIC_ASSERT(sizeof(int) == sizeof(boost::int32_t));
+
+} // anonymous namespace
+
+bool
+MergeHistory::isMergeHistoryFile(const std::string& filename) {
+
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	char magic[4];
+	if (!file.read(magic, 4))
+		return false;
+
+	return std::equal(magic, magic + 4, Magic);
+}
+
+void
+MergeHistory::read(const std::string& filename) {
+
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	if (!file)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"can not open " << filename);
+
+	char magic[4];
+	boost::uint32_t header[3];
+
+	file.read(magic, 4);
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+	if (!file || !std::equal(magic, magic + 4, Magic))
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				filename << " is not a merge-history file");
+
+	// check the sizes in the header against the file length before allocating
+
+	std::streamoff headerSize = 4 + sizeof(header);
+
+	file.seekg(0, std::ios::end);
+	boost::uint64_t fileSize = static_cast<boost::uint64_t>(file.tellg() - headerSize);
+	file.seekg(headerSize, std::ios::beg);
+
+	boost::uint64_t expectedSize =
+			static_cast<boost::uint64_t>(header[0])*header[1]*sizeof(int) +
+			static_cast<boost::uint64_t>(header[2])*sizeof(Merge);
+
+	if (!file || fileSize != expectedSize)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				filename << " has " << fileSize << " bytes of data, but its header (" << header[0] << "x" << header[1]
+				<< " pixels, " << header[2] << " merges) requires " << expectedSize);
+
+	_initialRegions.reshape(vigra::Shape2(header[0], header[1]));
+	_merges.resize(header[2]);
+
+	file.read(reinterpret_cast<char*>(_initialRegions.data()), _initialRegions.size()*sizeof(int));
+
+	if (!_merges.empty())
+		file.read(reinterpret_cast<char*>(&_merges[0]), _merges.size()*sizeof(Merge));
+
+	if (!file)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				filename << " is truncated");
+
+	// each merge has to create a new region
+	std::vector<unsigned int> parents;
+	parents.reserve(_merges.size());
+	for (unsigned int i = 0; i < _merges.size(); i++)
+		parents.push_back(_merges[i].parent);
+	std::sort(parents.begin(), parents.end());
+
+	std::vector<unsigned int>::const_iterator duplicate = std::adjacent_find(parents.begin(), parents.end());
+
+	if (duplicate != parents.end())
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				filename << " contains several merges with parent " << *duplicate);
+}
+
+void
+MergeHistory::write(const std::string& filename) const {
+
+	std::ofstream file(filename.c_str(), std::ios::binary);
+
+	boost::uint32_t header[3];
+	header[0] = _initialRegions.width();
+	header[1] = _initialRegions.height();
+	header[2] = _merges.size();
+
+	file.write(Magic, 4);
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(_initialRegions.data()), _initialRegions.size()*sizeof(int));
+
+	if (!_merges.empty())
+		file.write(reinterpret_cast<const char*>(&_merges[0]), _merges.size()*sizeof(Merge));
+
+	if (!file)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"can not write merge history to " << filename);
+}
@@ -0,0 +1,63 @@
+#ifndef MULTI2CUT_MERGETREE_MERGE_HISTORY_H__
+#define MULTI2CUT_MERGETREE_MERGE_HISTORY_H__
+
+#include <string>
+#include <vector>
+#include <vigra/multi_array.hxx>
+
+/**
+ * A compact representation of a merge tree: the label image of the initial
+ * regions and the list of merges in the order they were performed. Each merge
+ * creates a new region with an id larger than the ids of the two merged
+ * regions.
+ *
+ * The file format is binary in native byte order:
+ *
+ *   char[4]  magic "MTH1"
+ *   uint32   width
+ *   uint32   height
+ *   uint32   number of merges
+ *   int32    initial region labels, width*height in scan order
+ *   merges   number of merges times (uint32 a, uint32 b, uint32 parent, float score)
+ */
+class MergeHistory {
+
+public:
+
+	struct Merge {
+
+		unsigned int a;
+		unsigned int b;
+		unsigned int parent;
+		float        score;
+	};
+
+	typedef std::vector<Merge> MergesType;
+
+	MergeHistory() {}
+
+	MergeHistory(vigra::MultiArrayView<2, int> initialRegions, const MergesType& merges) :
+		_initialRegions(initialRegions),
+		_merges(merges) {}
+
+	/**
+	 * Test whether the given file starts like a merge-history file.
+	 */
+	static bool isMergeHistoryFile(const std::string& filename);
+
+	void read(const std::string& filename);
+
+	void write(const std::string& filename) const;
+
+	const vigra::MultiArray<2, int>& getInitialRegions() const { return _initialRegions; }
+
+	const MergesType& getMerges() const { return _merges; }
+
+private:
+
+	vigra::MultiArray<2, int> _initialRegions;
+
+	MergesType _merges;
+};
+
+#endif // MULTI2CUT_MERGETREE_MERGE_HISTORY_H__
@@ -0,0 +1,74 @@
+#include <util/Logger.h>
+#include <parallel/ParallelFor.h>
+#include "Merging.h"
+#include "MergeTreeEnsemble.h"
+#include "MultiplyMinRegionSize.h"
+#include "RandomPerturbation.h"
+#include "SmallFirst.h"
+
+util::ProgramOption optionEnsembleSize(
+		util::_long_name        = "ensembleSize",
+		util::_description_text = "Create this many merge trees with randomly perturbed scores (see randomPerturbationStdDev), starting from the same initial regions. The trees are created concurrently.");
+
+static logger::LogChannel mergetreeensemblelog("mergetreeensemblelog", "[MergeTreeEnsemble] ");
+
+MergeTreeEnsemble::MergeTreeEnsemble(
+		vigra::MultiArrayView<2, float> image,
+		vigra::MultiArrayView<2, int>   initialRegions) :
+	_merging(initialRegions, image),
+	_mei(_merging.getRag(), image) {
+
+	LOG_USER(mergetreeensemblelog) << "preparing edge intensity histograms..." << std::endl;
+
+	_merging.prepareScoringFunction(_mei);
+}
+
+void
+MergeTreeEnsemble::createMergeTrees(unsigned int numTrees) {
+
+	LOG_USER(mergetreeensemblelog)
+			<< "creating " << numTrees << " merge trees with "
+			<< parallel::getNumThreads() << " threads" << std::endl;
+
+	_mergeTrees.clear();
+	_mergeTrees.resize(numTrees);
+	_merges.clear();
+	_merges.resize(numTrees);
+
+	parallel::parallelFor(0, numTrees, TreeCreator(*this));
+}
+
+void
+MergeTreeEnsemble::createMergeTree(unsigned int i) {
+
+	IterativeRegionMerging merging(_merging);
+	MedianEdgeIntensity    mei(merging.getRag(), _mei);
+
+	// trees are created in parallel already
+	merging.setConcurrentScoring(false);
+
+	if (optionMergeSmallRegionsFirst) {
+
+		SmallFirst<MedianEdgeIntensity> scoringFunction(merging.getRag(), merging.getRegionStatistics(), mei);
+		merge(i, merging, scoringFunction);
+
+	} else {
+
+		MultiplyMinRegionSize<MedianEdgeIntensity> scoringFunction(merging.getRag(), merging.getRegionStatistics(), mei);
+		merge(i, merging, scoringFunction);
+	}
+}
+
+template <typename ScoringFunction>
+void
+MergeTreeEnsemble::merge(
+		unsigned int            i,
+		IterativeRegionMerging& merging,
+		ScoringFunction&        scoringFunction) {
+
+	RandomPerturbation<ScoringFunction> rp(scoringFunction, optionRandomPerturbationSeed.as<int>() + i);
+	merging.createMergeTree(rp);
+
+	_mergeTrees[i] = merging.getMergeTree();
+	_merges[i]     = merging.getMerges();
+}
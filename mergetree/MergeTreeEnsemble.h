@@ -0,0 +1,84 @@
+#ifndef MULTI2CUT_MERGETREE_MERGE_TREE_ENSEMBLE_H__
+#define MULTI2CUT_MERGETREE_MERGE_TREE_ENSEMBLE_H__
+
+#include <vector>
+#include <util/ProgramOptions.h>
+#include <vigra/multi_array.hxx>
+#include "IterativeRegionMerging.h"
+#include "MedianEdgeIntensity.h"
+#include "MergeHistory.h"
+
+extern util::ProgramOption optionEnsembleSize;
+
+/**
+ * Creates several merge trees with randomly perturbed scores from the same 
+ * initial regions.
+ *
+ * The region adjacency graph, the region statistics, and the edge intensity 
+ * histograms are computed once. The merge trees are then created concurrently, 
+ * each on its own copy of this state. Tree i is perturbed with seed 
+ * optionRandomPerturbationSeed + i.
+ */
+class MergeTreeEnsemble {
+
+public:
+
+	MergeTreeEnsemble(
+			vigra::MultiArrayView<2, float> image,
+			vigra::MultiArrayView<2, int>   initialRegions);
+
+	/**
+	 * Create the given number of merge trees.
+	 */
+	void createMergeTrees(unsigned int numTrees);
+
+	/**
+	 * The number of merge trees created.
+	 */
+	unsigned int size() const { return _mergeTrees.size(); }
+
+	/**
+	 * Get the i-th merge tree as an edge image.
+	 */
+	vigra::MultiArrayView<2, int> getMergeTree(unsigned int i) { return _mergeTrees[i]; }
+
+	/**
+	 * Get the merges of the i-th merge tree.
+	 */
+	const MergeHistory::MergesType& getMerges(unsigned int i) const { return _merges[i]; }
+
+private:
+
+	class TreeCreator {
+
+	public:
+
+		TreeCreator(MergeTreeEnsemble& ensemble) :
+			_ensemble(ensemble) {}
+
+		void operator()(unsigned int i) const { _ensemble.createMergeTree(i); }
+
+	private:
+
+		MergeTreeEnsemble& _ensemble;
+	};
+
+	void createMergeTree(unsigned int i);
+
+	template <typename ScoringFunction>
+	void merge(
+			unsigned int            i,
+			IterativeRegionMerging& merging,
+			ScoringFunction&        scoringFunction);
+
+	// the merge state before the first merge, copied for each tree
+	IterativeRegionMerging _merging;
+
+	// the edge intensity scoring function for _merging, copied for each tree
+	MedianEdgeIntensity _mei;
+
+	std::vector<vigra::MultiArray<2, int> > _mergeTrees;
+	std::vector<MergeHistory::MergesType>   _merges;
+};
+
+#endif // MULTI2CUT_MERGETREE_MERGE_TREE_ENSEMBLE_H__
@@ -0,0 +1,55 @@
+#include "Merging.h"
+#include "MedianEdgeIntensity.h"
+#include "SmallFirst.h"
+#include "MultiplyMinRegionSize.h"
+#include "RandomPerturbation.h"
+
+util::ProgramOption optionMergeSmallRegionsFirst(
+		util::_long_name        = "mergeSmallRegionsFirst",
+		util::_description_text = "Merge small regions first. For parameters, see smallRegionThreshold1, smallRegionThreshold2, and intensityThreshold.");
+
+void
+Merging::operator()(
+		IterativeRegionMerging&         merging,
+		vigra::MultiArrayView<2, float> image,
+		float                           maxScore) const {
+
+	MedianEdgeIntensity mei(merging.getRag(), image);
+
+	if (optionMergeSmallRegionsFirst) {
+
+		SmallFirst<MedianEdgeIntensity> scoringFunction(
+				merging.getRag(),
+				merging.getRegionStatistics(),
+				mei);
+
+		merge(merging, scoringFunction, maxScore);
+
+	} else {
+
+		MultiplyMinRegionSize<MedianEdgeIntensity> scoringFunction(
+				merging.getRag(),
+				merging.getRegionStatistics(),
+				mei);
+
+		merge(merging, scoringFunction, maxScore);
+	}
+}
+
+template <typename ScoringFunction>
+void
+Merging::merge(
+		IterativeRegionMerging& merging,
+		ScoringFunction&        scoringFunction,
+		float                   maxScore) const {
+
+	if (_randomPerturbation) {
+
+		RandomPerturbation<ScoringFunction> rp(scoringFunction);
+		merging.createMergeTree(rp, maxScore);
+
+	} else {
+
+		merging.createMergeTree(scoringFunction, maxScore);
+	}
+}
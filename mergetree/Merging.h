@@ -0,0 +1,42 @@
+#ifndef MULTI2CUT_MERGETREE_MERGING_H__
+#define MULTI2CUT_MERGETREE_MERGING_H__
+
+#include <util/ProgramOptions.h>
+#include <vigra/multi_array.hxx>
+#include "IterativeRegionMerging.h"
+
+extern util::ProgramOption optionMergeSmallRegionsFirst;
+
+/**
+ * Creates the scoring functions selected by the program options and merges 
+ * the regions. The IterativeRegionMerging has to be created with the image as 
+ * intensities, to provide the region statistics for the scoring functions.
+ */
+class Merging {
+
+public:
+
+	/**
+	 * @param randomPerturbation
+	 *              Randomly perturb the merge scores.
+	 */
+	Merging(bool randomPerturbation = false) :
+		_randomPerturbation(randomPerturbation) {}
+
+	void operator()(
+			IterativeRegionMerging&         merging,
+			vigra::MultiArrayView<2, float> image,
+			float                           maxScore) const;
+
+private:
+
+	template <typename ScoringFunction>
+	void merge(
+			IterativeRegionMerging& merging,
+			ScoringFunction&        scoringFunction,
+			float                   maxScore) const;
+
+	bool _randomPerturbation;
+};
+
+#endif // MULTI2CUT_MERGETREE_MERGING_H__
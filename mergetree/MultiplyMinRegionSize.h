@@ -1,10 +1,9 @@
 #ifndef MULTI2CUT_MERGETREE_MULTIPLY_MIN_REGION_SIZE_H__
 #define MULTI2CUT_MERGETREE_MULTIPLY_MIN_REGION_SIZE_H__
 
-#include <util/cont_map.hpp>
 #include <util/ProgramOptions.h>
 #include <util/assert.h>
-#include "NodeNumConverter.h"
+#include "RegionStatistics.h"
 #include "ScoringFunction.h"
 
 extern util::ProgramOption optionMultiplyMinRegionSizeExponent;
@@ -18,78 +17,52 @@ class MultiplyMinRegionSize : public ScoringFunction {
 
 public:
 
-	typedef vigra::GridGraph<2>                                                    GridGraphType;
-	typedef vigra::AdjacencyListGraph                                              RagType;
-	typedef util::cont_map<RagType::Node, std::size_t, NodeNumConverter<RagType> > RegionSizesType;
-	typedef util::cont_map<RagType::Node, float, NodeNumConverter<RagType> >       AverageIntensitiesType;
+	typedef vigra::GridGraph<2>  GridGraphType;
+	typedef RegionAdjacencyGraph RagType;
 
+	/**
+	 * Create a new MultiplyMinRegionSize scoring function on top of another 
+	 * one. The region sizes are read from the given statistics, which have to 
+	 * be kept up to date during merging (see 
+	 * IterativeRegionMerging::getRegionStatistics()).
+	 */
 	MultiplyMinRegionSize(
-			RagType&                              rag,
-			const vigra::MultiArrayView<2, float> intensities,
-			const vigra::MultiArrayView<2, int>   initialRegions,
-			ScoringFunctionType&                  scoringFunction) :
+			RagType&                rag,
+			const RegionStatistics& statistics,
+			ScoringFunctionType&    scoringFunction) :
 		_rag(rag),
-		_regionSizes(_rag),
-		_averageIntensities(_rag),
-		_intensities(intensities),
+		_statistics(statistics),
 		_scoringFunction(scoringFunction),
-		_exponent(optionMultiplyMinRegionSizeExponent) {
+		_exponent(optionMultiplyMinRegionSizeExponent) {}
 
-		// get initial region sizes and average intensities
-		vigra::MultiArray<2, int>::iterator   i = initialRegions.begin();
-		vigra::MultiArray<2, float>::iterator j = intensities.begin();
+	float operator()(const RagType::Edge& edge, const GridEdgesType& gridEdges) {
 
-		UTIL_ASSERT(initialRegions.shape() == intensities.shape());
-
-		for (; i != initialRegions.end(); i++, j++) {
-
-			RagType::Node node = _rag.nodeFromId(*i);
-			float value = *j;
-
-			_regionSizes[node]++;
-			_averageIntensities[node] += value;
-		}
-
-		for (RagType::NodeIt node(_rag); node != lemon::INVALID; ++node)
-			_averageIntensities[*node] /= _regionSizes[*node];
-	}
-
-	float operator()(const RagType::Edge& edge, std::vector<GridGraphType::Edge>& gridEdges) {
-
-		RagType::Node u = _rag.u(edge);
-		RagType::Node v = _rag.v(edge);
+		std::size_t u = _statistics.size(_rag.id(_rag.u(edge)));
+		std::size_t v = _statistics.size(_rag.id(_rag.v(edge)));
 
 		float score = _scoringFunction(edge, gridEdges);
 
-		score *= pow(std::min(_regionSizes[u], _regionSizes[v]), _exponent);
+		score *= pow(std::min(u, v), _exponent);
 
 		return score;
 	}
 
 	void onMerge(const RagType::Edge& edge, const RagType::Node newRegion) {
 
-		RagType::Node u = _rag.u(edge);
-		RagType::Node v = _rag.v(edge);
-
-		_regionSizes[newRegion] =
-				_regionSizes[u] +
-				_regionSizes[v];
+		_scoringFunction.onMerge(edge, newRegion);
+	}
 
-		_averageIntensities[newRegion] =
-				(_averageIntensities[u]*_regionSizes[u]+
-				 _averageIntensities[v]*_regionSizes[v])/
-				(_regionSizes[u] + _regionSizes[v]);
+	void onBoundaryMerge(const RagType::Edge& target, const RagType::Edge& source) {
 
-		_scoringFunction.onMerge(edge, newRegion);
+		_scoringFunction.onBoundaryMerge(target, source);
 	}
 
-private:
+	bool concurrentScoring() const { return _scoringFunction.concurrentScoring(); }
 
-	RagType&               _rag;
-	RegionSizesType        _regionSizes;
-	AverageIntensitiesType _averageIntensities;
+private:
 
-	vigra::MultiArrayView<2, float> _intensities;
+	RagType&                _rag;
+	const RegionStatistics& _statistics;
 
 	ScoringFunctionType& _scoringFunction;
 
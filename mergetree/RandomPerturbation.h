@@ -1,7 +1,8 @@
 #ifndef MULTI2CUT_MERGETREE_RANDOM_PERTURBATION_H__
 #define MULTI2CUT_MERGETREE_RANDOM_PERTURBATION_H__
 
-#include <boost/math/distributions/normal.hpp>
+#include <cmath>
+#include <boost/cstdint.hpp>
 #include <util/ProgramOptions.h>
 #include <util/Logger.h>
 #include "ScoringFunction.h"
@@ -11,34 +12,40 @@ extern util::ProgramOption optionRandomPerturbationSeed;
 extern logger::LogChannel randomperturbationlog;
 
 /**
- * A scoring function that randomly perturbes the scores of another scoring 
- * function. For that, perturbations are drawn from a normal distrubution with 
+ * A scoring function that randomly perturbes the scores of another scoring
+ * function. For that, perturbations are drawn from a normal distrubution with
  * standard deviation of optionRandomPerturbationStdDev.
+ *
+ * The perturbation of an edge is a function of the seed and the edge id only
+ * (a counter-based generator followed by a Box-Muller transform). The
+ * perturbed scores are therefore the same regardless of the order in which
+ * edges are scored, and edges can be scored concurrently if the perturbed
+ * scoring function allows it.
  */
 template <typename ScoringFunctionType>
 class RandomPerturbation : public ScoringFunction {
 
 public:
 
-	RandomPerturbation(ScoringFunctionType& scoringFunction) :
+	RandomPerturbation(
+			ScoringFunctionType& scoringFunction,
+			int seed = optionRandomPerturbationSeed.as<int>()) :
 		_scoringFunction(scoringFunction),
-		_normalDistribution(0, 1),
-		_stdDev(optionRandomPerturbationStdDev) {
+		_stdDev(optionRandomPerturbationStdDev),
+		_seed(static_cast<boost::uint32_t>(seed)) {
 
 			LOG_USER(randomperturbationlog)
 					<< "randomly perturb edge scores with stddev "
 					<< optionRandomPerturbationStdDev.as<double>()
+					<< " and seed " << seed
 					<< std::endl;
-
-			srand(optionRandomPerturbationSeed.as<int>());
 		}
 
-	float operator()(const RagType::Edge& edge, std::vector<GridGraphType::Edge>& gridEdges) {
+	float operator()(const RagType::Edge& edge, const GridEdgesType& gridEdges) {
 
 		float score = _scoringFunction(edge, gridEdges);
 
-		double uniform = (double)rand()/RAND_MAX;
-		double pertubation = boost::math::quantile(_normalDistribution, uniform);
+		double pertubation = standardNormal(edge.id());
 
 		pertubation = pertubation*_stdDev*1.0/gridEdges.size();
 
@@ -50,14 +57,47 @@ public:
 		_scoringFunction.onMerge(edge, newRegion);
 	}
 
+	void onBoundaryMerge(const RagType::Edge& target, const RagType::Edge& source) {
+
+		_scoringFunction.onBoundaryMerge(target, source);
+	}
+
+	/**
+	 * The perturbations do not depend on the scoring order.
+	 */
+	bool concurrentScoring() const { return _scoringFunction.concurrentScoring(); }
+
 private:
 
-	ScoringFunctionType&               _scoringFunction;
-	boost::math::normal_distribution<> _normalDistribution;
+	// a sample of the standard normal distribution for the given edge
+	double standardNormal(boost::uint32_t edgeId) const {
+
+		boost::uint64_t a = splitMix64((static_cast<boost::uint64_t>(_seed) << 32) | edgeId);
+		boost::uint64_t b = splitMix64(a);
+
+		// uniform in (0,1] and [0,1) from the upper 53 bits
+		double u1 = ((a >> 11) + 1)*(1.0/9007199254740992.0);
+		double u2 = (b >> 11)*(1.0/9007199254740992.0);
+
+		return std::sqrt(-2.0*std::log(u1))*std::cos(2.0*M_PI*u2);
+	}
+
+	// the SplitMix64 finalizer, a bijective mixing function
+	static boost::uint64_t splitMix64(boost::uint64_t x) {
+
+		x += UINT64_C(0x9e3779b97f4a7c15);
+		x  = (x ^ (x >> 30))*UINT64_C(0xbf58476d1ce4e5b9);
+		x  = (x ^ (x >> 27))*UINT64_C(0x94d049bb133111eb);
+
+		return x ^ (x >> 31);
+	}
+
+	ScoringFunctionType& _scoringFunction;
 
 	// the baseline stddev
 	double _stdDev;
+
+	boost::uint32_t _seed;
 };
 
 #endif // MULTI2CUT_MERGETREE_RANDOM_PERTURBATION_H__
-
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <util/assert.h>
+#include "RegionAdjacencyGraph.h"
+
+namespace {
+
+// order (neighbor, edge) pairs by neighbor only
+struct NeighborLess {
+
+	bool operator()(
+			const std::pair<RegionAdjacencyGraph::index_type, RegionAdjacencyGraph::index_type>& a,
+			RegionAdjacencyGraph::index_type neighbor) const {
+
+		return a.first < neighbor;
+	}
+};
+
+} // anonymous namespace
+
+RegionAdjacencyGraph::Node
+RegionAdjacencyGraph::addNode() {
+
+	return addNode(_nodes.size());
+}
+
+RegionAdjacencyGraph::Node
+RegionAdjacencyGraph::addNode(index_type id) {
+
+	UTIL_ASSERT_REL(id, >=, 0);
+
+	if (id >= static_cast<index_type>(_nodes.size()))
+		_nodes.resize(id + 1);
+
+	if (!_nodes[id].valid) {
+
+		_nodes[id].valid = true;
+		_numNodes++;
+	}
+
+	return Node(id);
+}
+
+RegionAdjacencyGraph::Edge
+RegionAdjacencyGraph::addEdge(const Node& u, const Node& v) {
+
+	UTIL_ASSERT(valid(u.id()));
+	UTIL_ASSERT(valid(v.id()));
+	UTIL_ASSERT(u != v);
+
+	Edge edge(_edges.size());
+	_edges.push_back(std::make_pair(u.id(), v.id()));
+
+	insertNeighbor(_nodes[u.id()].neighbors, v.id(), edge.id());
+	insertNeighbor(_nodes[v.id()].neighbors, u.id(), edge.id());
+
+	return edge;
+}
+
+RegionAdjacencyGraph::Edge
+RegionAdjacencyGraph::findEdge(const Node& u, const Node& v) const {
+
+	if (!valid(u.id()) || !valid(v.id()))
+		return Edge();
+
+	// search in the smaller neighborhood
+	const NeighborsType& uNeighbors = _nodes[u.id()].neighbors;
+	const NeighborsType& vNeighbors = _nodes[v.id()].neighbors;
+
+	const NeighborsType& neighbors = (uNeighbors.size() <= vNeighbors.size() ? uNeighbors : vNeighbors);
+	index_type           neighbor  = (uNeighbors.size() <= vNeighbors.size() ? v.id() : u.id());
+
+	NeighborsType::const_iterator i = std::lower_bound(neighbors.begin(), neighbors.end(), neighbor, NeighborLess());
+
+	if (i == neighbors.end() || i->first != neighbor)
+		return Edge();
+
+	return Edge(i->second);
+}
+
+void
+RegionAdjacencyGraph::detach(const Node& node) {
+
+	NeighborsType& neighbors = _nodes[node.id()].neighbors;
+
+	for (NeighborsType::const_iterator i = neighbors.begin(); i != neighbors.end(); i++)
+		eraseNeighbor(_nodes[i->first].neighbors, node.id());
+
+	// release the memory
+	NeighborsType().swap(neighbors);
+}
+
+void
+RegionAdjacencyGraph::insertNeighbor(NeighborsType& neighbors, index_type neighbor, index_type edge) {
+
+	// new nodes have the largest ids, this is the common case during merging
+	if (neighbors.empty() || neighbors.back().first < neighbor) {
+
+		neighbors.push_back(std::make_pair(neighbor, edge));
+		return;
+	}
+
+	NeighborsType::iterator i = std::lower_bound(neighbors.begin(), neighbors.end(), neighbor, NeighborLess());
+
+	UTIL_ASSERT(i == neighbors.end() || i->first != neighbor);
+
+	neighbors.insert(i, std::make_pair(neighbor, edge));
+}
+
+void
+RegionAdjacencyGraph::eraseNeighbor(NeighborsType& neighbors, index_type neighbor) {
+
+	NeighborsType::iterator i = std::lower_bound(neighbors.begin(), neighbors.end(), neighbor, NeighborLess());
+
+	if (i != neighbors.end() && i->first == neighbor)
+		neighbors.erase(i);
+}
@@ -0,0 +1,261 @@
+#ifndef MULTI2CUT_MERGETREE_REGION_ADJACENCY_GRAPH_H__
+#define MULTI2CUT_MERGETREE_REGION_ADJACENCY_GRAPH_H__
+
+#include <utility>
+#include <vector>
+
+#include <vigra/graphs.hxx>
+
+/**
+ * A region adjacency graph for agglomeration. Nodes and edges are stored in
+ * contiguous arrays and addressed by their ids. Each node has a vector of its
+ * neighbors and the connecting edges, sorted by the neighbor id, such that an
+ * edge between two nodes is found by a binary search.
+ *
+ * The interface follows the subset of the lemon graph concept that is used by
+ * IterativeRegionMerging and the scoring functions. In addition, a node can be
+ * detached from its neighbors after it was merged. Its edges stay in the graph,
+ * but are not reported as incident edges anymore.
+ */
+class RegionAdjacencyGraph {
+
+public:
+
+	typedef int index_type;
+
+	RegionAdjacencyGraph() : _numNodes(0) {}
+
+	class Node {
+
+	public:
+
+		Node() : _id(-1) {}
+
+		Node(lemon::Invalid) : _id(-1) {}
+
+		explicit Node(index_type id) : _id(id) {}
+
+		bool operator==(const Node& other) const { return _id == other._id; }
+		bool operator!=(const Node& other) const { return _id != other._id; }
+		bool operator<(const Node& other) const  { return _id < other._id; }
+
+		bool operator==(lemon::Invalid) const { return _id == -1; }
+		bool operator!=(lemon::Invalid) const { return _id != -1; }
+
+		index_type id() const { return _id; }
+
+	private:
+
+		index_type _id;
+	};
+
+	class Edge {
+
+	public:
+
+		Edge() : _id(-1) {}
+
+		Edge(lemon::Invalid) : _id(-1) {}
+
+		explicit Edge(index_type id) : _id(id) {}
+
+		bool operator==(const Edge& other) const { return _id == other._id; }
+		bool operator!=(const Edge& other) const { return _id != other._id; }
+		bool operator<(const Edge& other) const  { return _id < other._id; }
+
+		bool operator==(lemon::Invalid) const { return _id == -1; }
+		bool operator!=(lemon::Invalid) const { return _id != -1; }
+
+		index_type id() const { return _id; }
+
+	private:
+
+		index_type _id;
+	};
+
+	/**
+	 * Iterator over all valid nodes.
+	 */
+	class NodeIt : public Node {
+
+	public:
+
+		NodeIt(const RegionAdjacencyGraph& graph) :
+			Node(graph.firstNode(0)),
+			_graph(&graph) {}
+
+		NodeIt& operator++() {
+
+			static_cast<Node&>(*this) = _graph->firstNode(id() + 1);
+			return *this;
+		}
+
+		Node operator*() const { return *this; }
+
+	private:
+
+		const RegionAdjacencyGraph* _graph;
+	};
+
+	/**
+	 * Iterator over all edges.
+	 */
+	class EdgeIt : public Edge {
+
+	public:
+
+		EdgeIt(const RegionAdjacencyGraph& graph) :
+			Edge(graph._edges.empty() ? Edge() : Edge(0)),
+			_graph(&graph) {}
+
+		EdgeIt& operator++() {
+
+			if (id() + 1 < static_cast<index_type>(_graph->_edges.size()))
+				static_cast<Edge&>(*this) = Edge(id() + 1);
+			else
+				static_cast<Edge&>(*this) = Edge();
+
+			return *this;
+		}
+
+		Edge operator*() const { return *this; }
+
+	private:
+
+		const RegionAdjacencyGraph* _graph;
+	};
+
+	/**
+	 * Iterator over the edges incident to a node that was not detached.
+	 */
+	class IncEdgeIt : public Edge {
+
+	public:
+
+		IncEdgeIt(const RegionAdjacencyGraph& graph, const Node& node) :
+			_neighbors(&graph._nodes[node.id()].neighbors),
+			_pos(0) {
+
+			update();
+		}
+
+		IncEdgeIt& operator++() {
+
+			_pos++;
+			update();
+
+			return *this;
+		}
+
+		Edge operator*() const { return *this; }
+
+	private:
+
+		void update() {
+
+			if (_pos < _neighbors->size())
+				static_cast<Edge&>(*this) = Edge((*_neighbors)[_pos].second);
+			else
+				static_cast<Edge&>(*this) = Edge();
+		}
+
+		const std::vector<std::pair<index_type, index_type> >* _neighbors;
+		unsigned int                                          _pos;
+	};
+
+	/**
+	 * Add a new node with an id one larger than the current largest one.
+	 */
+	Node addNode();
+
+	/**
+	 * Add a node with the given id, if it does not exist yet.
+	 */
+	Node addNode(index_type id);
+
+	/**
+	 * Add an edge between u and v. The edge must not exist yet.
+	 */
+	Edge addEdge(const Node& u, const Node& v);
+
+	/**
+	 * Find the edge between u and v. Returns lemon::INVALID, if there is none
+	 * or one of the nodes was detached.
+	 */
+	Edge findEdge(const Node& u, const Node& v) const;
+
+	/**
+	 * Remove all edges incident to node from the adjacency of node and its
+	 * neighbors. The edges are still accessible via their ids.
+	 */
+	void detach(const Node& node);
+
+	/**
+	 * Reserve memory for the given number of nodes and edges.
+	 */
+	void reserve(index_type numNodes, index_type numEdges) {
+
+		_nodes.reserve(numNodes);
+		_edges.reserve(numEdges);
+	}
+
+	Node u(const Edge& edge) const { return Node(_edges[edge.id()].first); }
+	Node v(const Edge& edge) const { return Node(_edges[edge.id()].second); }
+
+	index_type id(const Node& node) const { return node.id(); }
+	index_type id(const Edge& edge) const { return edge.id(); }
+
+	Node nodeFromId(index_type id) const { return (valid(id) ? Node(id) : Node()); }
+	Edge edgeFromId(index_type id) const { return Edge(id); }
+
+	index_type maxNodeId() const { return static_cast<index_type>(_nodes.size()) - 1; }
+	index_type maxEdgeId() const { return static_cast<index_type>(_edges.size()) - 1; }
+
+	index_type nodeNum() const { return _numNodes; }
+	index_type edgeNum() const { return _edges.size(); }
+
+private:
+
+	typedef std::vector<std::pair<index_type, index_type> > NeighborsType;
+
+	struct NodeData {
+
+		NodeData() : valid(false) {}
+
+		// pairs of (neighbor id, edge id), sorted by neighbor id
+		NeighborsType neighbors;
+
+		// false for unused node ids
+		bool valid;
+	};
+
+	bool valid(index_type id) const {
+
+		return id >= 0 && id < static_cast<index_type>(_nodes.size()) && _nodes[id].valid;
+	}
+
+	// the first valid node with an id not smaller than the given one
+	Node firstNode(index_type id) const {
+
+		for (; id < static_cast<index_type>(_nodes.size()); id++)
+			if (_nodes[id].valid)
+				return Node(id);
+
+		return Node();
+	}
+
+	// add a (neighbor, edge) pair to the sorted neighbors of a node
+	static void insertNeighbor(NeighborsType& neighbors, index_type neighbor, index_type edge);
+
+	// remove a neighbor from the sorted neighbors of a node
+	static void eraseNeighbor(NeighborsType& neighbors, index_type neighbor);
+
+	std::vector<NodeData> _nodes;
+
+	// pairs of (u, v) node ids
+	std::vector<std::pair<index_type, index_type> > _edges;
+
+	index_type _numNodes;
+};
+
+#endif // MULTI2CUT_MERGETREE_REGION_ADJACENCY_GRAPH_H__
@@ -0,0 +1,127 @@
+#ifndef MULTI2CUT_MERGETREE_REGION_STATISTICS_H__
+#define MULTI2CUT_MERGETREE_REGION_STATISTICS_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+/**
+ * Statistics of the regions of a merge tree, indexed by region (node) id. The
+ * statistics of the initial regions are accumulated in one pass over the
+ * image, the statistics of a merged region are computed from the statistics
+ * of its children in constant time.
+ */
+class RegionStatistics {
+
+public:
+
+	struct Statistics {
+
+		Statistics() :
+			size(0),
+			sum(0),
+			sumOfSquares(0),
+			minX(std::numeric_limits<int>::max()),
+			minY(std::numeric_limits<int>::max()),
+			maxX(std::numeric_limits<int>::min()),
+			maxY(std::numeric_limits<int>::min()),
+			perimeter(0) {}
+
+		// the number of pixels
+		std::size_t size;
+
+		// the sum and sum of squares of the pixel intensities
+		double sum;
+		double sumOfSquares;
+
+		// the bounding box, inclusive
+		int minX, minY;
+		int maxX, maxY;
+
+		// the number of pixel pairs (in the 4-neighborhood) that connect the
+		// region to other regions, without the image border
+		std::size_t perimeter;
+
+		double mean() const { return (size == 0 ? 0 : sum/size); }
+
+		double variance() const { return (size == 0 ? 0 : sumOfSquares/size - mean()*mean()); }
+	};
+
+	/**
+	 * Add a pixel to an initial region.
+	 */
+	void addPixel(int id, int x, int y, float intensity) {
+
+		Statistics& s = get(id);
+
+		s.size++;
+		s.sum          += intensity;
+		s.sumOfSquares += intensity*intensity;
+		s.minX = std::min(s.minX, x);
+		s.minY = std::min(s.minY, y);
+		s.maxX = std::max(s.maxX, x);
+		s.maxY = std::max(s.maxY, y);
+	}
+
+	/**
+	 * Add a pixel pair on the boundary between two initial regions.
+	 */
+	void addBoundary(int u, int v) {
+
+		get(u).perimeter++;
+		get(v).perimeter++;
+	}
+
+	/**
+	 * Set the statistics of region c to the union of regions a and b, which
+	 * share a boundary of the given length.
+	 */
+	void merge(int a, int b, int c, std::size_t boundaryLength) {
+
+		get(c);
+
+		const Statistics& sa = _statistics[a];
+		const Statistics& sb = _statistics[b];
+		Statistics&       sc = _statistics[c];
+
+		sc.size         = sa.size + sb.size;
+		sc.sum          = sa.sum + sb.sum;
+		sc.sumOfSquares = sa.sumOfSquares + sb.sumOfSquares;
+		sc.minX         = std::min(sa.minX, sb.minX);
+		sc.minY         = std::min(sa.minY, sb.minY);
+		sc.maxX         = std::max(sa.maxX, sb.maxX);
+		sc.maxY         = std::max(sa.maxY, sb.maxY);
+		sc.perimeter    = sa.perimeter + sb.perimeter - 2*boundaryLength;
+	}
+
+	/**
+	 * Reserve memory for regions up to the given id.
+	 */
+	void reserve(int maxId) { _statistics.reserve(maxId + 1); }
+
+	const Statistics& operator[](int id) const { return _statistics[id]; }
+
+	/**
+	 * The largest id with statistics, -1 if there are none.
+	 */
+	int maxId() const { return static_cast<int>(_statistics.size()) - 1; }
+
+	std::size_t size(int id) const { return _statistics[id].size; }
+
+	double mean(int id) const { return _statistics[id].mean(); }
+
+private:
+
+	Statistics& get(int id) {
+
+		if (_statistics.size() <= static_cast<std::size_t>(id))
+			_statistics.resize(id + 1);
+
+		return _statistics[id];
+	}
+
+	std::vector<Statistics> _statistics;
+};
+
+#endif // MULTI2CUT_MERGETREE_REGION_STATISTICS_H__
@@ -2,7 +2,8 @@
 #define MULTI2CUT_MERGETREE_SCORING_FUNCTION_H__
 
 #include <vigra/multi_gridgraph.hxx>
-#include <vigra/adjacency_list_graph.hxx>
+#include "RegionAdjacencyGraph.h"
+#include "SpliceableLists.h"
 
 /**
  * Default (empty) interface definition for scoring functions to be used with 
@@ -12,13 +13,16 @@ class ScoringFunction {
 
 public:
 
-	typedef vigra::GridGraph<2>       GridGraphType;
-	typedef vigra::AdjacencyListGraph RagType;
+	typedef vigra::GridGraph<2>  GridGraphType;
+	typedef RegionAdjacencyGraph RagType;
+
+	// the grid edges along the boundary of two regions
+	typedef SpliceableLists<GridGraphType::Edge>::List GridEdgesType;
 
 	/**
 	 * Called to score an edge.
 	 */
-	float operator()(const RagType::Edge& edge, std::vector<GridGraphType::Edge>& gridEdges) {
+	float operator()(const RagType::Edge& edge, const GridEdgesType& gridEdges) {
 		return 0;
 	}
 
@@ -27,6 +31,22 @@ public:
 	 * statistics.
 	 */
 	void onMerge(const RagType::Edge& edge, const RagType::Node newRegion) {}
+
+	/**
+	 * Called when the boundary of edge source is appended to the boundary of 
+	 * edge target. This happens for each edge of a merged region to one of its 
+	 * neighbors, before onMerge is called. Use this to merge per-edge 
+	 * statistics.
+	 */
+	void onBoundaryMerge(const RagType::Edge& target, const RagType::Edge& source) {}
+
+	/**
+	 * Return true, if operator() can safely be called concurrently for 
+	 * different edges between two merges. IterativeRegionMerging uses this to 
+	 * score the initial edges in parallel. onMerge and onBoundaryMerge are 
+	 * never called concurrently.
+	 */
+	bool concurrentScoring() const { return false; }
 };
 
 #endif // MULTI2CUT_MERGETREE_SCORING_FUNCTION_H__
@@ -1,10 +1,9 @@
 #ifndef MULTI2CUT_MERGETREE_SMALL_FIRST_H__
 #define MULTI2CUT_MERGETREE_SMALL_FIRST_H__
 
-#include <util/cont_map.hpp>
 #include <util/ProgramOptions.h>
 #include <util/assert.h>
-#include "NodeNumConverter.h"
+#include "RegionStatistics.h"
 #include "ScoringFunction.h"
 
 extern util::ProgramOption optionSmallRegionThreshold1;
@@ -25,10 +24,8 @@ class SmallFirst : public ScoringFunction {
 
 public:
 
-	typedef vigra::GridGraph<2>                                                    GridGraphType;
-	typedef vigra::AdjacencyListGraph                                              RagType;
-	typedef util::cont_map<RagType::Node, std::size_t, NodeNumConverter<RagType> > RegionSizesType;
-	typedef util::cont_map<RagType::Node, float, NodeNumConverter<RagType> >       AverageIntensitiesType;
+	typedef vigra::GridGraph<2>  GridGraphType;
+	typedef RegionAdjacencyGraph RagType;
 
 	/**
 	 * Amount to subtract from small region scores, to make sure they are merged 
@@ -37,40 +34,24 @@ public:
 	 */
 	static const float Offset;
 
+	/**
+	 * Create a new SmallFirst scoring function on top of another one. The 
+	 * region sizes and intensities are read from the given statistics, which 
+	 * have to be kept up to date during merging (see 
+	 * IterativeRegionMerging::getRegionStatistics()).
+	 */
 	SmallFirst(
-			RagType&                              rag,
-			const vigra::MultiArrayView<2, float> intensities,
-			const vigra::MultiArrayView<2, int>   initialRegions,
-			ScoringFunctionType&                  scoringFunction) :
+			RagType&                rag,
+			const RegionStatistics& statistics,
+			ScoringFunctionType&    scoringFunction) :
 		_rag(rag),
-		_regionSizes(_rag),
-		_averageIntensities(_rag),
-		_intensities(intensities),
+		_statistics(statistics),
 		_scoringFunction(scoringFunction),
 		_t1(optionSmallRegionThreshold1),
 		_t2(optionSmallRegionThreshold2),
-		_i(optionIntensityThreshold) {
-
-		// get initial region sizes and average intensities
-		vigra::MultiArray<2, int>::iterator   i = initialRegions.begin();
-		vigra::MultiArray<2, float>::iterator j = intensities.begin();
-
-		UTIL_ASSERT(initialRegions.shape() == intensities.shape());
-
-		for (; i != initialRegions.end(); i++, j++) {
-
-			RagType::Node node = _rag.nodeFromId(*i);
-			float value = *j;
-
-			_regionSizes[node]++;
-			_averageIntensities[node] += value;
-		}
+		_i(optionIntensityThreshold) {}
 
-		for (RagType::NodeIt node(_rag); node != lemon::INVALID; ++node)
-			_averageIntensities[*node] /= _regionSizes[*node];
-	}
-
-	float operator()(const RagType::Edge& edge, std::vector<GridGraphType::Edge>& gridEdges) {
+	float operator()(const RagType::Edge& edge, const GridEdgesType& gridEdges) {
 
 		float score = _scoringFunction(edge, gridEdges);
 
@@ -85,55 +66,47 @@ public:
 
 	void onMerge(const RagType::Edge& edge, const RagType::Node newRegion) {
 
-		RagType::Node u = _rag.u(edge);
-		RagType::Node v = _rag.v(edge);
-
-		_regionSizes[newRegion] =
-				_regionSizes[u] +
-				_regionSizes[v];
+		_scoringFunction.onMerge(edge, newRegion);
+	}
 
-		_averageIntensities[newRegion] =
-				(_averageIntensities[u]*_regionSizes[u]+
-				 _averageIntensities[v]*_regionSizes[v])/
-				(_regionSizes[u] + _regionSizes[v]);
+	void onBoundaryMerge(const RagType::Edge& target, const RagType::Edge& source) {
 
-		_scoringFunction.onMerge(edge, newRegion);
+		_scoringFunction.onBoundaryMerge(target, source);
 	}
 
+	bool concurrentScoring() const { return _scoringFunction.concurrentScoring(); }
+
 private:
 
 	bool smallRegionEdge(const RagType::Edge& edge) const {
 
-		RagType::Node u = _rag.u(edge);
-		RagType::Node v = _rag.v(edge);
-		RagType::Node smaller;
+		int u = _rag.id(_rag.u(edge));
+		int v = _rag.id(_rag.v(edge));
+		int smaller;
 		std::size_t minSize;
 
-		if (_regionSizes[u] < _regionSizes[v]) {
+		if (_statistics.size(u) < _statistics.size(v)) {
 
 			smaller = u;
-			minSize = _regionSizes[u];
+			minSize = _statistics.size(u);
 
 		} else {
 
 			smaller = v;
-			minSize = _regionSizes[v];
+			minSize = _statistics.size(v);
 		}
 
 		if (minSize < _t1)
 			return true;
 
-		if (minSize < _t2 && _averageIntensities[smaller] > _i)
+		if (minSize < _t2 && _statistics.mean(smaller) > _i)
 			return true;
 
 		return false;
 	}
 
-	RagType&               _rag;
-	RegionSizesType        _regionSizes;
-	AverageIntensitiesType _averageIntensities;
-
-	vigra::MultiArrayView<2, float> _intensities;
+	RagType&                _rag;
+	const RegionStatistics& _statistics;
 
 	ScoringFunctionType& _scoringFunction;
 
@@ -0,0 +1,263 @@
+#ifndef MULTI2CUT_MERGETREE_SPLICEABLE_LISTS_H__
+#define MULTI2CUT_MERGETREE_SPLICEABLE_LISTS_H__
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include <util/assert.h>
+
+/**
+ * A collection of lists of values, addressed by integral ids, that can be
+ * concatenated in constant time. The values are stored once in a flat array,
+ * split into segments. Each list is a singly linked chain of segments, such
+ * that splicing one list to the end of another only relinks the chains and
+ * does not copy or move any value.
+ *
+ * The memory for the list lookup grows with the largest id used.
+ */
+template <typename ValueType>
+class SpliceableLists {
+
+	struct Segment;
+	struct Chain;
+
+public:
+
+	typedef unsigned int IdType;
+
+	/**
+	 * Forward iterator over the values of a list.
+	 */
+	class const_iterator : public std::iterator<std::forward_iterator_tag, const ValueType> {
+
+	public:
+
+		const_iterator() :
+			_lists(0),
+			_segment(End),
+			_pos(0) {}
+
+		const ValueType& operator*() const { return _lists->_values[_pos]; }
+
+		const ValueType* operator->() const { return &_lists->_values[_pos]; }
+
+		const_iterator& operator++() {
+
+			_pos++;
+
+			if (_pos == _lists->_segments[_segment].end)
+				enterSegment(_lists->_segments[_segment].next);
+
+			return *this;
+		}
+
+		const_iterator operator++(int) {
+
+			const_iterator copy = *this;
+			++(*this);
+			return copy;
+		}
+
+		bool operator==(const const_iterator& other) const {
+
+			return _segment == other._segment && _pos == other._pos;
+		}
+
+		bool operator!=(const const_iterator& other) const {
+
+			return !(*this == other);
+		}
+
+	private:
+
+		friend class SpliceableLists;
+
+		const_iterator(const SpliceableLists* lists, unsigned int segment) :
+			_lists(lists),
+			_pos(0) {
+
+			enterSegment(segment);
+		}
+
+		// move to the first value of the next non-empty segment
+		void enterSegment(unsigned int segment) {
+
+			while (segment != End && _lists->_segments[segment].begin == _lists->_segments[segment].end)
+				segment = _lists->_segments[segment].next;
+
+			_segment = segment;
+			_pos     = (segment == End ? 0 : _lists->_segments[segment].begin);
+		}
+
+		const SpliceableLists* _lists;
+		unsigned int           _segment;
+		unsigned int           _pos;
+	};
+
+	/**
+	 * A lightweight view on one of the lists. It stays valid until the list is
+	 * modified.
+	 */
+	class List {
+
+	public:
+
+		typedef typename SpliceableLists::const_iterator const_iterator;
+		typedef const_iterator                           iterator;
+		typedef ValueType                                value_type;
+
+		const_iterator begin() const { return const_iterator(_lists, _chain.head); }
+
+		const_iterator end() const { return const_iterator(); }
+
+		unsigned int size() const { return _chain.size; }
+
+		bool empty() const { return _chain.size == 0; }
+
+	private:
+
+		friend class SpliceableLists;
+
+		List(const SpliceableLists* lists, const Chain& chain) :
+			_lists(lists),
+			_chain(chain) {}
+
+		const SpliceableLists* _lists;
+		Chain                  _chain;
+	};
+
+	/**
+	 * Reserve memory for ids up to maxId and for the given number of values.
+	 */
+	void reserve(IdType maxId, unsigned int numValues = 0) {
+
+		if (_chains.size() <= maxId)
+			_chains.resize(maxId + 1);
+		_segments.reserve(maxId + 1);
+		_values.reserve(numValues);
+	}
+
+	/**
+	 * Append the values [begin, end) to the list with the given id. This
+	 * copies the values once into a new segment.
+	 */
+	template <typename Iterator>
+	void append(IdType id, Iterator begin, Iterator end) {
+
+		Segment segment;
+		segment.begin = _values.size();
+		_values.insert(_values.end(), begin, end);
+		segment.end   = _values.size();
+		segment.next  = End;
+
+		if (segment.begin == segment.end)
+			return;
+
+		_segments.push_back(segment);
+
+		Chain single;
+		single.head = single.tail = _segments.size() - 1;
+		single.size = segment.end - segment.begin;
+
+		link(chain(id), single);
+	}
+
+	/**
+	 * Move all values of list source to the end of list target in constant
+	 * time. The source list is empty afterwards.
+	 */
+	void splice(IdType target, IdType source) {
+
+		UTIL_ASSERT(target != source);
+
+		// make sure both chains exist before taking references
+		chain(std::max(target, source));
+
+		Chain& sourceChain = chain(source);
+		Chain& targetChain = chain(target);
+
+		link(targetChain, sourceChain);
+		sourceChain = Chain();
+	}
+
+	/**
+	 * Get a view on the list with the given id.
+	 */
+	List operator[](IdType id) const {
+
+		if (id >= _chains.size())
+			return List(this, Chain());
+
+		return List(this, _chains[id]);
+	}
+
+	/**
+	 * The total number of values in all lists.
+	 */
+	unsigned int numValues() const { return _values.size(); }
+
+	/**
+	 * The total number of segments in all lists.
+	 */
+	unsigned int numSegments() const { return _segments.size(); }
+
+private:
+
+	static const unsigned int End;
+
+	struct Segment {
+
+		// range of the values in _values
+		unsigned int begin;
+		unsigned int end;
+
+		// the next segment in the same list
+		unsigned int next;
+	};
+
+	struct Chain {
+
+		Chain() :
+			head(End),
+			tail(End),
+			size(0) {}
+
+		unsigned int head;
+		unsigned int tail;
+		unsigned int size;
+	};
+
+	Chain& chain(IdType id) {
+
+		if (_chains.size() <= id)
+			_chains.resize(id + 1);
+
+		return _chains[id];
+	}
+
+	// link chain b to the end of chain a
+	void link(Chain& a, const Chain& b) {
+
+		if (b.head == End)
+			return;
+
+		if (a.head == End)
+			a.head = b.head;
+		else
+			_segments[a.tail].next = b.head;
+
+		a.tail  = b.tail;
+		a.size += b.size;
+	}
+
+	std::vector<ValueType> _values;
+	std::vector<Segment>   _segments;
+	std::vector<Chain>     _chains;
+};
+
+template <typename ValueType>
+const unsigned int SpliceableLists<ValueType>::End = std::numeric_limits<unsigned int>::max();
+
+#endif // MULTI2CUT_MERGETREE_SPLICEABLE_LISTS_H__
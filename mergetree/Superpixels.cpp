@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <cmath>
+#include <vigra/slic.hxx>
+#include <vigra/multi_convolution.hxx>
+#include <vigra/multi_watersheds.hxx>
+#include <util/Logger.h>
+#include <util/assert.h>
+#include <parallel/ParallelFor.h>
+#include "Superpixels.h"
+
+util::ProgramOption optionSlicSuperpixels(
+		util::_long_name        = "slicSuperpixels",
+		util::_description_text = "Use SLIC superpixels instead of watersheds to obtain initial regions.");
+
+util::ProgramOption optionSlicIntensityScaling(
+		util::_long_name        = "slicIntensityScaling",
+		util::_description_text = "How to scale the image intensity for comparison to spatial distance. Default is 1.0.",
+		util::_default_value    = 1.0);
+
+util::ProgramOption optionSliceSize(
+		util::_long_name        = "slicSize",
+		util::_description_text = "An upper limit on the SLIC superpixel size. Default is 10.",
+		util::_default_value    = 10);
+
+util::ProgramOption optionSuperpixelBlockSize(
+		util::_long_name        = "superpixelBlockSize",
+		util::_description_text = "Find the initial regions in parallel in horizontal blocks of this many rows. The result "
+		                          "differs from processing the whole image at once close to the block seams. Default is 0, "
+		                          "which processes the whole image at once.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionSuperpixelBlockOverlap(
+		util::_long_name        = "superpixelBlockOverlap",
+		util::_description_text = "The number of rows by which blocks are enlarged to find watersheds, to avoid artifacts at "
+		                          "the block seams. Default is 64.",
+		util::_default_value    = 64);
+
+static logger::LogChannel superpixelslog("superpixelslog", "[Superpixels] ");
+
+// the number of rows of the stripes for parallel smoothing, does not affect 
+// the result
+static const int SmoothingStripeSize = 256;
+
+unsigned int
+Superpixels::operator()(
+		vigra::MultiArrayView<2, float> image,
+		vigra::MultiArrayView<2, int>   initialRegions) const {
+
+	int blockSize = optionSuperpixelBlockSize.as<int>();
+
+	if (blockSize > 0 && blockSize < image.shape(1)) {
+
+		if (optionSlicSuperpixels)
+			return blockwiseSlic(image, initialRegions, blockSize);
+
+		return blockwiseWatersheds(image, initialRegions, blockSize);
+	}
+
+	if (optionSlicSuperpixels)
+		return vigra::slicSuperpixels(
+				image,
+				initialRegions,
+				optionSlicIntensityScaling.as<double>(),
+				optionSliceSize.as<double>(),
+				vigra::SlicOptions().iterations(100));
+
+	return vigra::watershedsMultiArray(
+			image,
+			initialRegions,
+			vigra::IndirectNeighborhood,
+			vigra::WatershedOptions().seedOptions(vigra::SeedOptions().extendedMinima()));
+}
+
+unsigned int
+Superpixels::blockwiseWatersheds(
+		vigra::MultiArrayView<2, float> image,
+		vigra::MultiArrayView<2, int>   initialRegions,
+		int                             blockSize) const {
+
+	int overlap   = std::max(0, optionSuperpixelBlockOverlap.as<int>());
+	int numBlocks = (image.shape(1) + blockSize - 1)/blockSize;
+
+	LOG_DEBUG(superpixelslog) << "finding watersheds in " << numBlocks << " blocks" << std::endl;
+
+	// the seeds are found on the whole image, such that the labels agree 
+	// between blocks
+	vigra::MultiArray<2, int> seeds(image.shape());
+	unsigned int maxLabel = vigra::generateWatershedSeeds(
+			image,
+			seeds,
+			vigra::IndirectNeighborhood,
+			vigra::SeedOptions().extendedMinima());
+
+	parallel::parallelFor(0, numBlocks, WatershedBlock(image, seeds, initialRegions, blockSize, overlap));
+
+	return maxLabel;
+}
+
+void
+Superpixels::WatershedBlock::operator()(unsigned int block) const {
+
+	int width  = _image.shape(0);
+	int height = _image.shape(1);
+
+	int begin = block*_blockSize;
+	int end   = std::min(begin + _blockSize, height);
+
+	int enlargedBegin = std::max(0, begin - _overlap);
+	int enlargedEnd   = std::min(height, end + _overlap);
+
+	// the enlarged block spans whole rows and is therefore connected, without 
+	// a seed its pixels would stay unlabelled: grow it until it contains one 
+	// (the whole image does)
+	int grow = std::max(1, std::max(_overlap, _blockSize));
+	while (!hasSeed(enlargedBegin, enlargedEnd) && (enlargedBegin > 0 || enlargedEnd < height)) {
+
+		enlargedBegin = std::max(0, enlargedBegin - grow);
+		enlargedEnd   = std::min(height, enlargedEnd + grow);
+
+		LOG_DEBUG(superpixelslog)
+				<< "block " << block << " has no seed, growing it to rows "
+				<< enlargedBegin << " to " << enlargedEnd << std::endl;
+	}
+
+	vigra::Shape2 enlargedFrom(0, enlargedBegin);
+	vigra::Shape2 enlargedTo(width, enlargedEnd);
+
+	// the default options flood from the seeds in the label array
+	vigra::MultiArray<2, int> labels(_seeds.subarray(enlargedFrom, enlargedTo));
+	vigra::watershedsMultiArray(
+			_image.subarray(enlargedFrom, enlargedTo),
+			labels,
+			vigra::IndirectNeighborhood,
+			vigra::WatershedOptions());
+
+	// labels start at 1
+	for (vigra::MultiArray<2, int>::iterator i = labels.begin(); i != labels.end(); i++)
+		UTIL_ASSERT_REL(*i, >, 0);
+
+	_initialRegions.subarray(vigra::Shape2(0, begin), vigra::Shape2(width, end)) =
+			labels.subarray(vigra::Shape2(0, begin - enlargedBegin), vigra::Shape2(width, end - enlargedBegin));
+}
+
+bool
+Superpixels::WatershedBlock::hasSeed(int begin, int end) const {
+
+	vigra::MultiArrayView<2, int> seeds =
+			_seeds.subarray(vigra::Shape2(0, begin), vigra::Shape2(_seeds.shape(0), end));
+
+	for (vigra::MultiArrayView<2, int>::iterator i = seeds.begin(); i != seeds.end(); i++)
+		if (*i != 0)
+			return true;
+
+	return false;
+}
+
+unsigned int
+Superpixels::blockwiseSlic(
+		vigra::MultiArrayView<2, float> image,
+		vigra::MultiArrayView<2, int>   initialRegions,
+		int                             blockSize) const {
+
+	// align the seams with the SLIC seed grid
+	int spacing = std::max(1, static_cast<int>(std::ceil(optionSliceSize.as<double>())));
+	blockSize   = ((blockSize + spacing - 1)/spacing)*spacing;
+
+	int numBlocks = (image.shape(1) + blockSize - 1)/blockSize;
+
+	LOG_DEBUG(superpixelslog) << "finding SLIC superpixels in " << numBlocks << " blocks" << std::endl;
+
+	std::vector<unsigned int> numLabels(numBlocks, 0);
+	parallel::parallelFor(0, numBlocks, SlicBlock(image, initialRegions, blockSize, numLabels));
+
+	std::vector<unsigned int> offsets(numBlocks, 0);
+	for (int i = 1; i < numBlocks; i++)
+		offsets[i] = offsets[i - 1] + numLabels[i - 1];
+
+	parallel::parallelFor(1, numBlocks, RelabelBlock(initialRegions, blockSize, offsets));
+
+	return offsets[numBlocks - 1] + numLabels[numBlocks - 1];
+}
+
+void
+Superpixels::SlicBlock::operator()(unsigned int block) const {
+
+	int width  = _image.shape(0);
+	int height = _image.shape(1);
+
+	vigra::Shape2 from(0, block*_blockSize);
+	vigra::Shape2 to(width, std::min(static_cast<int>(block + 1)*_blockSize, height));
+
+	vigra::MultiArrayView<2, int> labels = _initialRegions.subarray(from, to);
+
+	_numLabels[block] = vigra::slicSuperpixels(
+			_image.subarray(from, to),
+			labels,
+			optionSlicIntensityScaling.as<double>(),
+			optionSliceSize.as<double>(),
+			vigra::SlicOptions().iterations(100));
+}
+
+void
+Superpixels::RelabelBlock::operator()(unsigned int block) const {
+
+	int width  = _initialRegions.shape(0);
+	int height = _initialRegions.shape(1);
+
+	int begin = block*_blockSize;
+	int end   = std::min(begin + _blockSize, height);
+
+	int offset = _offsets[block];
+
+	for (int y = begin; y < end; y++)
+		for (int x = 0; x < width; x++)
+			_initialRegions(x, y) += offset;
+}
+
+void
+GaussianSmoothing::operator()(vigra::MultiArrayView<2, float> image, double sigma) const {
+
+	// more than the radius of the kernel used by vigra (3*sigma, rounded)
+	int radius = static_cast<int>(std::ceil(3.0*sigma)) + 1;
+
+	int numStripes = (image.shape(1) + SmoothingStripeSize - 1)/SmoothingStripeSize;
+
+	vigra::MultiArray<2, float> smoothed(image.shape());
+	parallel::parallelFor(0, numStripes, SmoothStripe(image, smoothed, sigma, SmoothingStripeSize, radius));
+
+	image = smoothed;
+}
+
+void
+GaussianSmoothing::SmoothStripe::operator()(unsigned int stripe) const {
+
+	int width  = _image.shape(0);
+	int height = _image.shape(1);
+
+	int begin = stripe*_stripeSize;
+	int end   = std::min(begin + _stripeSize, height);
+
+	int enlargedBegin = std::max(0, begin - _radius);
+	int enlargedEnd   = std::min(height, end + _radius);
+
+	// stripes span whole rows, such that the pass along x is exact; the pass 
+	// along y sees all rows within the kernel radius of the stripe
+	vigra::MultiArray<2, float> enlarged(_image.subarray(vigra::Shape2(0, enlargedBegin), vigra::Shape2(width, enlargedEnd)));
+	vigra::gaussianSmoothMultiArray(enlarged, enlarged, _sigma);
+
+	_smoothed.subarray(vigra::Shape2(0, begin), vigra::Shape2(width, end)) =
+			enlarged.subarray(vigra::Shape2(0, begin - enlargedBegin), vigra::Shape2(width, end - enlargedBegin));
+}
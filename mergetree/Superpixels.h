@@ -0,0 +1,179 @@
+#ifndef MULTI2CUT_MERGETREE_SUPERPIXELS_H__
+#define MULTI2CUT_MERGETREE_SUPERPIXELS_H__
+
+#include <vector>
+#include <util/ProgramOptions.h>
+#include <vigra/multi_array.hxx>
+
+extern util::ProgramOption optionSlicSuperpixels;
+extern util::ProgramOption optionSlicIntensityScaling;
+extern util::ProgramOption optionSliceSize;
+extern util::ProgramOption optionSuperpixelBlockSize;
+extern util::ProgramOption optionSuperpixelBlockOverlap;
+
+/**
+ * Finds the initial regions for merging by watersheds or SLIC superpixels, 
+ * depending on the program options.
+ *
+ * If optionSuperpixelBlockSize is set (it is not by default), the image is 
+ * split into horizontal blocks of that many rows, which are processed in 
+ * parallel:
+ *
+ * Watersheds are seeded at the extended minima of the whole image. Each block 
+ * is flooded from these seeds on the block enlarged by 
+ * optionSuperpixelBlockOverlap rows, and only the rows of the block itself are 
+ * kept. Since all blocks share the same seed labels, a basin that crosses a 
+ * seam keeps its label on both sides. An enlarged block without any seed is 
+ * grown until it contains one, such that every pixel is labelled. The result 
+ * equals the serial watersheds except for pixels whose flooding path in the 
+ * serial case leaves the (possibly grown) enlarged block.
+ *
+ * SLIC superpixels are found independently in each block, with block sizes 
+ * rounded up to a multiple of the SLIC grid spacing, and relabelled to be 
+ * unique. Superpixels do not cross block seams, otherwise their size and shape 
+ * are bounded by the grid spacing as in the serial case.
+ *
+ * Both results depend on the block size, but not on the number of threads.
+ */
+class Superpixels {
+
+public:
+
+	/**
+	 * Label the regions of the given image starting at 1 and return the 
+	 * maximal label.
+	 */
+	unsigned int operator()(
+			vigra::MultiArrayView<2, float> image,
+			vigra::MultiArrayView<2, int>   initialRegions) const;
+
+private:
+
+	class WatershedBlock {
+
+	public:
+
+		WatershedBlock(
+				vigra::MultiArrayView<2, float> image,
+				vigra::MultiArrayView<2, int>   seeds,
+				vigra::MultiArrayView<2, int>   initialRegions,
+				int                             blockSize,
+				int                             overlap) :
+			_image(image),
+			_seeds(seeds),
+			_initialRegions(initialRegions),
+			_blockSize(blockSize),
+			_overlap(overlap) {}
+
+		void operator()(unsigned int block) const;
+
+	private:
+
+		// check whether there is a seed in the rows [begin, end)
+		bool hasSeed(int begin, int end) const;
+
+		vigra::MultiArrayView<2, float> _image;
+		vigra::MultiArrayView<2, int>   _seeds;
+		vigra::MultiArrayView<2, int>   _initialRegions;
+		int                             _blockSize;
+		int                             _overlap;
+	};
+
+	class SlicBlock {
+
+	public:
+
+		SlicBlock(
+				vigra::MultiArrayView<2, float> image,
+				vigra::MultiArrayView<2, int>   initialRegions,
+				int                             blockSize,
+				std::vector<unsigned int>&      numLabels) :
+			_image(image),
+			_initialRegions(initialRegions),
+			_blockSize(blockSize),
+			_numLabels(numLabels) {}
+
+		void operator()(unsigned int block) const;
+
+	private:
+
+		vigra::MultiArrayView<2, float> _image;
+		vigra::MultiArrayView<2, int>   _initialRegions;
+		int                             _blockSize;
+		std::vector<unsigned int>&      _numLabels;
+	};
+
+	class RelabelBlock {
+
+	public:
+
+		RelabelBlock(
+				vigra::MultiArrayView<2, int>    initialRegions,
+				int                              blockSize,
+				const std::vector<unsigned int>& offsets) :
+			_initialRegions(initialRegions),
+			_blockSize(blockSize),
+			_offsets(offsets) {}
+
+		void operator()(unsigned int block) const;
+
+	private:
+
+		vigra::MultiArrayView<2, int>    _initialRegions;
+		int                              _blockSize;
+		const std::vector<unsigned int>& _offsets;
+	};
+
+	unsigned int blockwiseWatersheds(
+			vigra::MultiArrayView<2, float> image,
+			vigra::MultiArrayView<2, int>   initialRegions,
+			int                             blockSize) const;
+
+	unsigned int blockwiseSlic(
+			vigra::MultiArrayView<2, float> image,
+			vigra::MultiArrayView<2, int>   initialRegions,
+			int                             blockSize) const;
+};
+
+/**
+ * Gaussian smoothing of an image, in parallel over horizontal stripes. Each 
+ * stripe is smoothed with enough context rows for the kernel, such that the 
+ * result is identical to the serial vigra::gaussianSmoothMultiArray.
+ */
+class GaussianSmoothing {
+
+public:
+
+	void operator()(vigra::MultiArrayView<2, float> image, double sigma) const;
+
+private:
+
+	class SmoothStripe {
+
+	public:
+
+		SmoothStripe(
+				vigra::MultiArrayView<2, float> image,
+				vigra::MultiArrayView<2, float> smoothed,
+				double                          sigma,
+				int                             stripeSize,
+				int                             radius) :
+			_image(image),
+			_smoothed(smoothed),
+			_sigma(sigma),
+			_stripeSize(stripeSize),
+			_radius(radius) {}
+
+		void operator()(unsigned int stripe) const;
+
+	private:
+
+		vigra::MultiArrayView<2, float> _image;
+		vigra::MultiArrayView<2, float> _smoothed;
+		double                          _sigma;
+		int                             _stripeSize;
+		int                             _radius;
+	};
+};
+
+#endif // MULTI2CUT_MERGETREE_SUPERPIXELS_H__
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <util/exceptions.h>
+#include "TiledRegionMerging.h"
+
+util::ProgramOption optionTileSize(
+		util::_long_name        = "tileSize",
+		util::_description_text = "Create the merge tree in tiles of this size. Regions inside a tile are merged in parallel, "
+		                          "before the regions at the seams between tiles are merged in a final pass.");
+
+util::ProgramOption optionTileOverlap(
+		util::_long_name        = "tileOverlap",
+		util::_description_text = "The number of pixels by which tiles are enlarged to find the initial regions, to avoid "
+		                          "artifacts at the tile borders. Default is 32.",
+		util::_default_value    = 32);
+
+util::ProgramOption optionTileMergeThreshold(
+		util::_long_name        = "tileMergeThreshold",
+		util::_description_text = "The maximal score of merges to perform inside the tiles, required with tileSize. All other "
+		                          "merges are performed in the final pass. The scale depends on the scoring function: by "
+		                          "default, scores are edge intensities multiplied by the size of the smaller region to the "
+		                          "power of minRegionSizeExponent.");
+
+logger::LogChannel tiledmergetreelog("tiledmergetreelog", "[TiledRegionMerging] ");
+
+TiledRegionMerging::TiledRegionMerging(const ShapeType& shape, bool keepMerges) :
+	_shape(shape),
+	_tileSize(optionTileSize.as<int>()),
+	_tileOverlap(optionTileOverlap.as<int>()),
+	_tileMergeThreshold(0),
+	_regions(shape),
+	_keepMerges(keepMerges),
+	_numInitialRegions(0) {
+
+	UTIL_ASSERT_REL(_tileSize, >, 0);
+
+	if (!optionTileMergeThreshold)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"tiled merging needs a tileMergeThreshold on the scale of the merge scores");
+
+	_tileMergeThreshold = optionTileMergeThreshold.as<float>();
+
+	for (int y = 0; y < _shape[1]; y += _tileSize)
+		for (int x = 0; x < _shape[0]; x += _tileSize) {
+
+			Tile tile;
+			tile.begin       = ShapeType(x, y);
+			tile.end         = ShapeType(std::min(x + _tileSize, static_cast<int>(_shape[0])), std::min(y + _tileSize, static_cast<int>(_shape[1])));
+			tile.labelOffset        = 0;
+			tile.numLabels          = 0;
+			tile.initialLabelOffset = 0;
+			tile.initialNumLabels   = 0;
+
+			_tiles.push_back(tile);
+		}
+}
+
+std::vector<int>
+TiledRegionMerging::seamRegions(const Tile& tile, const vigra::MultiArrayView<2, int> regions) const {
+
+	std::vector<int> seamRegions;
+
+	int width  = regions.shape(0);
+	int height = regions.shape(1);
+
+	// seams are tile borders that are not image borders
+	if (tile.begin[0] > 0)
+		for (int y = 0; y < height; y++)
+			seamRegions.push_back(regions(0, y));
+	if (tile.end[0] < _shape[0])
+		for (int y = 0; y < height; y++)
+			seamRegions.push_back(regions(width - 1, y));
+	if (tile.begin[1] > 0)
+		for (int x = 0; x < width; x++)
+			seamRegions.push_back(regions(x, 0));
+	if (tile.end[1] < _shape[1])
+		for (int x = 0; x < width; x++)
+			seamRegions.push_back(regions(x, height - 1));
+
+	std::sort(seamRegions.begin(), seamRegions.end());
+	seamRegions.erase(std::unique(seamRegions.begin(), seamRegions.end()), seamRegions.end());
+
+	return seamRegions;
+}
+
+void
+TiledRegionMerging::collectTileResult(Tile& tile, IterativeRegionMerging& merging, vigra::MultiArrayView<2, int> regions) {
+
+	// the root region for each initial local label, 0 if not seen yet
+	std::vector<int> rootLabels(tile.numLabels + 1, 0);
+
+	for (vigra::MultiArrayView<2, int>::iterator i = regions.begin(); i != regions.end(); i++)
+		if (rootLabels[*i] == 0)
+			rootLabels[*i] = merging.getRoot(*i);
+
+	// assign consecutive labels to the roots
+	std::vector<int> rootIds;
+	for (unsigned int label = 1; label < rootLabels.size(); label++)
+		if (rootLabels[label] != 0)
+			rootIds.push_back(rootLabels[label]);
+	std::sort(rootIds.begin(), rootIds.end());
+	rootIds.erase(std::unique(rootIds.begin(), rootIds.end()), rootIds.end());
+
+	if (_keepMerges)
+		tile.rootIds = rootIds;
+
+	tile.leafDistances.assign(1, 0);
+	for (unsigned int i = 0; i < rootIds.size(); i++)
+		tile.leafDistances.push_back(merging.getLeafDistance(rootIds[i]));
+
+	for (vigra::MultiArrayView<2, int>::iterator i = regions.begin(); i != regions.end(); i++)
+		*i = (std::lower_bound(rootIds.begin(), rootIds.end(), rootLabels[*i]) - rootIds.begin()) + 1;
+
+	tile.numLabels = rootIds.size();
+}
+
+void
+TiledRegionMerging::collectRemainingRegions(
+		const vigra::MultiArrayView<2, float>          image,
+		RegionStatistics&                              statistics,
+		std::vector<IterativeRegionMerging::Boundary>& boundaries) const {
+
+	for (int y = 0; y < _regions.height(); y++)
+		for (int x = 0; x < _regions.width(); x++)
+			statistics.addPixel(_regions(x, y), x, y, image(x, y));
+
+	IterativeRegionMerging::GridGraphType grid(_shape);
+
+	for (IterativeRegionMerging::GridGraphType::EdgeIt edge(grid); edge != lemon::INVALID; ++edge) {
+
+		IterativeRegionMerging::Boundary boundary;
+		boundary.edge = *edge;
+		boundary.u    = _regions[grid.u(*edge)];
+		boundary.v    = _regions[grid.v(*edge)];
+
+		if (boundary.u != boundary.v)
+			boundaries.push_back(boundary);
+	}
+}
+
+void
+TiledRegionMerging::relabelTile(const Tile& tile) {
+
+	vigra::MultiArrayView<2, int> regions = _regions.subarray(tile.begin, tile.end);
+
+	for (vigra::MultiArrayView<2, int>::iterator i = regions.begin(); i != regions.end(); i++)
+		*i += tile.labelOffset;
+}
+
+unsigned int
+TiledRegionMerging::collectTileMerges(std::vector<unsigned int>& regionIds) {
+
+	_merges.clear();
+
+	// new regions are numbered after the initial regions
+	unsigned int nextId = _numInitialRegions + 1;
+
+	// the remaining regions are labelled consecutively in the order of the
+	// tiles, starting at 1
+	regionIds.assign(1, 0);
+
+	for (unsigned int i = 0; i < _tiles.size(); i++) {
+
+		Tile& tile = _tiles[i];
+
+		// the merging of the tile used the local labels as node ids
+		std::vector<unsigned int> historyIds(tile.initialNumLabels + 1, 0);
+		for (int label = 1; label <= tile.initialNumLabels; label++)
+			historyIds[label] = tile.initialLabelOffset + label;
+
+		appendMerges(tile.merges, historyIds, nextId);
+
+		for (unsigned int j = 0; j < tile.rootIds.size(); j++)
+			regionIds.push_back(historyIds[tile.rootIds[j]]);
+
+		MergeHistory::MergesType().swap(tile.merges);
+		std::vector<int>().swap(tile.rootIds);
+	}
+
+	return nextId;
+}
+
+void
+TiledRegionMerging::appendMerges(
+		const MergeHistory::MergesType& merges,
+		std::vector<unsigned int>&      historyIds,
+		unsigned int&                   nextId) {
+
+	for (unsigned int i = 0; i < merges.size(); i++) {
+
+		MergeHistory::Merge merge = merges[i];
+
+		merge.a = historyIds[merge.a];
+		merge.b = historyIds[merge.b];
+
+		if (historyIds.size() <= merge.parent)
+			historyIds.resize(merge.parent + 1, 0);
+		historyIds[merge.parent] = nextId++;
+
+		merge.parent = historyIds[merge.parent];
+
+		_merges.push_back(merge);
+	}
+}
+
+int
+TiledRegionMerging::computeLabelOffsets() {
+
+	int offset = 0;
+	for (unsigned int i = 0; i < _tiles.size(); i++) {
+
+		_tiles[i].labelOffset = offset;
+		offset += _tiles[i].numLabels;
+	}
+
+	return offset;
+}
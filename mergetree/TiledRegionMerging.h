@@ -0,0 +1,420 @@
+#ifndef MULTI2CUT_MERGETREE_TILED_REGION_MERGING_H__
+#define MULTI2CUT_MERGETREE_TILED_REGION_MERGING_H__
+
+#include <vector>
+#include <util/ProgramOptions.h>
+#include <util/Logger.h>
+#include <vigra/multi_array.hxx>
+#include <parallel/ParallelFor.h>
+#include "IterativeRegionMerging.h"
+#include "MergeHistory.h"
+
+extern util::ProgramOption optionTileSize;
+extern util::ProgramOption optionTileOverlap;
+extern util::ProgramOption optionTileMergeThreshold;
+
+extern logger::LogChannel tiledmergetreelog;
+
+/**
+ * Creates a merge tree for a large image by merging in tiles first.
+ *
+ * The image is split into tiles of optionTileSize. Initial regions are found
+ * for each tile in parallel on the tile enlarged by optionTileOverlap, and
+ * cropped to the tile. Inside each tile, regions that do not touch a seam to
+ * another tile are merged in parallel, as long as the merge score is below
+ * optionTileMergeThreshold. The remaining regions of all tiles are stitched
+ * into one region adjacency graph and merged in a final pass.
+ *
+ * The leaf distances of regions found in the tiles are final, such that each
+ * tile writes its part of the merge-tree image directly to the result. The
+ * final pass is created from the statistics of the remaining regions and the
+ * boundaries between them only, and the region image is released before.
+ * Besides the image and the result, the largest allocations are therefore
+ * the region image and the buffers of the tiles merged concurrently. The
+ * scoring function of the final pass might still allocate per-pixel data for
+ * the whole image (like MedianEdgeIntensity does).
+ *
+ * If the merges are kept, no merge-tree image is written. Instead, the merges
+ * of all tiles and of the final pass are collected with ids that are unique
+ * over the whole image, such that they can be stored as a MergeHistory of the
+ * initial regions. A copy of the initial regions is kept for that, which is a
+ * quarter of the size of the merge-tree image.
+ */
+class TiledRegionMerging {
+
+public:
+
+	typedef vigra::Shape2 ShapeType;
+
+	/**
+	 * @param keepMerges
+	 *              Collect the merges instead of writing a merge-tree image.
+	 */
+	TiledRegionMerging(const ShapeType& shape, bool keepMerges = false);
+
+	/**
+	 * Find the initial regions in each tile. Superpixels has to be a functor
+	 * with
+	 *
+	 *   unsigned int operator()(
+	 *       vigra::MultiArrayView<2, float> image,
+	 *       vigra::MultiArrayView<2, int>   labels) const
+	 *
+	 * that labels the regions of a tile image starting at 1 and returns the
+	 * maximal label. It is called concurrently for different tiles.
+	 */
+	template <typename Superpixels>
+	void createInitialRegions(
+			const vigra::MultiArrayView<2, float> image,
+			const Superpixels&                    superpixels);
+
+	/**
+	 * Get the initial regions, valid between createInitialRegions and
+	 * createMergeTree, or after createInitialRegions if the merges are kept.
+	 */
+	vigra::MultiArrayView<2, int> getInitialRegions() { return (_keepMerges ? _initialRegions : _regions); }
+
+	/**
+	 * Create the merge tree. Merging has to be a functor with
+	 *
+	 *   void operator()(
+	 *       IterativeRegionMerging&         merging,
+	 *       vigra::MultiArrayView<2, float> image,
+	 *       float                           maxScore) const
+	 *
+	 * that calls merging.createMergeTree(scoringFunction, maxScore) with a
+	 * scoring function for the given image. It is called concurrently for
+	 * different tiles.
+	 */
+	template <typename Merging>
+	void createMergeTree(
+			const vigra::MultiArrayView<2, float> image,
+			const Merging&                        merging);
+
+	/**
+	 * Get the final merge tree as an edge image. Empty if the merges are kept.
+	 */
+	vigra::MultiArrayView<2, int> getMergeTree() { return _mergeTree; }
+
+	/**
+	 * Get the merges of the tiles and the final pass, in the order they were
+	 * performed. The leaves are the labels of getInitialRegions(). Only
+	 * available if the merges are kept.
+	 */
+	const MergeHistory::MergesType& getMerges() const { return _merges; }
+
+private:
+
+	struct Tile {
+
+		// the part of the image covered by this tile
+		ShapeType begin;
+		ShapeType end;
+
+		// the offset to add to the local region labels of this tile
+		int labelOffset;
+
+		// the number of local region labels of this tile
+		int numLabels;
+
+		// the leaf distances of the regions left after merging in the tile,
+		// indexed by local label
+		std::vector<int> leafDistances;
+
+		// if the merges are kept, the label offset and number of the initial
+		// regions, the merges in the tile, and the ids of the regions left
+		// after merging in the tile, as node ids of the tile's merging
+		int                      initialLabelOffset;
+		int                      initialNumLabels;
+		MergeHistory::MergesType merges;
+		std::vector<int>         rootIds;
+	};
+
+	template <typename Superpixels>
+	class TileSuperpixels {
+
+	public:
+
+		TileSuperpixels(
+				TiledRegionMerging&                   tiled,
+				const vigra::MultiArrayView<2, float> image,
+				const Superpixels&                    superpixels) :
+			_tiled(tiled),
+			_image(image),
+			_superpixels(superpixels) {}
+
+		void operator()(unsigned int i) const { _tiled.createTileRegions(_tiled._tiles[i], _image, _superpixels); }
+
+	private:
+
+		TiledRegionMerging&                   _tiled;
+		const vigra::MultiArrayView<2, float> _image;
+		const Superpixels&                    _superpixels;
+	};
+
+	template <typename Merging>
+	class TileMerging {
+
+	public:
+
+		TileMerging(
+				TiledRegionMerging&                   tiled,
+				const vigra::MultiArrayView<2, float> image,
+				const Merging&                        merging) :
+			_tiled(tiled),
+			_image(image),
+			_merging(merging) {}
+
+		void operator()(unsigned int i) const { _tiled.mergeTile(_tiled._tiles[i], _image, _merging); }
+
+	private:
+
+		TiledRegionMerging&                   _tiled;
+		const vigra::MultiArrayView<2, float> _image;
+		const Merging&                        _merging;
+	};
+
+	// adds the label offset of each tile to its local labels
+	class TileRelabel {
+
+	public:
+
+		TileRelabel(TiledRegionMerging& tiled) :
+			_tiled(tiled) {}
+
+		void operator()(unsigned int i) const { _tiled.relabelTile(_tiled._tiles[i]); }
+
+	private:
+
+		TiledRegionMerging& _tiled;
+	};
+
+	template <typename Superpixels>
+	void createTileRegions(
+			Tile&                                 tile,
+			const vigra::MultiArrayView<2, float> image,
+			const Superpixels&                    superpixels);
+
+	template <typename Merging>
+	void mergeTile(
+			Tile&                                 tile,
+			const vigra::MultiArrayView<2, float> image,
+			const Merging&                        merging);
+
+	// find the regions of a tile that touch a seam to another tile
+	std::vector<int> seamRegions(const Tile& tile, const vigra::MultiArrayView<2, int> regions) const;
+
+	// replace the local labels of a tile with the ids of the regions that are
+	// left after merging in the tile, and collect their leaf distances
+	void collectTileResult(Tile& tile, IterativeRegionMerging& merging, vigra::MultiArrayView<2, int> regions);
+
+	// collect the statistics of the remaining regions and the boundaries
+	// between them
+	void collectRemainingRegions(
+			const vigra::MultiArrayView<2, float>          image,
+			RegionStatistics&                              statistics,
+			std::vector<IterativeRegionMerging::Boundary>& boundaries) const;
+
+	void relabelTile(const Tile& tile);
+
+	// append the merges of all tiles to _merges and find the ids of the
+	// remaining regions in the merge history, returns the next free id
+	unsigned int collectTileMerges(std::vector<unsigned int>& regionIds);
+
+	// append merges to _merges, with the ids given by historyIds, which is
+	// extended by the ids of the new regions
+	void appendMerges(
+			const MergeHistory::MergesType& merges,
+			std::vector<unsigned int>&      historyIds,
+			unsigned int&                   nextId);
+
+	// compute the label offsets from the number of labels per tile
+	int computeLabelOffsets();
+
+	ShapeType _shape;
+
+	int   _tileSize;
+	int   _tileOverlap;
+	float _tileMergeThreshold;
+
+	std::vector<Tile> _tiles;
+
+	// the initial regions, and the regions left after merging in the tiles
+	vigra::MultiArray<2, int> _regions;
+
+	// the merge-tree image, written by the tiles and the final pass
+	vigra::MultiArray<2, int> _mergeTree;
+
+	bool _keepMerges;
+
+	// if the merges are kept, a copy of the initial regions, their number, and
+	// the merges
+	vigra::MultiArray<2, int> _initialRegions;
+	int                       _numInitialRegions;
+	MergeHistory::MergesType  _merges;
+};
+
+template <typename Superpixels>
+void
+TiledRegionMerging::createInitialRegions(
+		const vigra::MultiArrayView<2, float> image,
+		const Superpixels&                    superpixels) {
+
+	UTIL_ASSERT(image.shape() == _shape);
+
+	LOG_USER(tiledmergetreelog)
+			<< "finding initial regions in " << _tiles.size() << " tiles" << std::endl;
+
+	parallel::parallelFor(0, _tiles.size(), TileSuperpixels<Superpixels>(*this, image, superpixels));
+
+	int numLabels = computeLabelOffsets();
+
+	parallel::parallelFor(0, _tiles.size(), TileRelabel(*this));
+
+	LOG_USER(tiledmergetreelog) << "found " << numLabels << " initial regions" << std::endl;
+
+	_numInitialRegions = numLabels;
+
+	if (_keepMerges)
+		_initialRegions = _regions;
+}
+
+template <typename Merging>
+void
+TiledRegionMerging::createMergeTree(
+		const vigra::MultiArrayView<2, float> image,
+		const Merging&                        merging) {
+
+	UTIL_ASSERT(image.shape() == _shape);
+
+	if (!_keepMerges)
+		_mergeTree.reshape(_shape*2, 0);
+
+	LOG_USER(tiledmergetreelog)
+			<< "merging regions in " << _tiles.size() << " tiles" << std::endl;
+
+	parallel::parallelFor(0, _tiles.size(), TileMerging<Merging>(*this, image, merging));
+
+	int numLabels = computeLabelOffsets();
+
+	parallel::parallelFor(0, _tiles.size(), TileRelabel(*this));
+
+	LOG_USER(tiledmergetreelog)
+			<< "merging " << numLabels << " remaining regions of all tiles" << std::endl;
+
+	// the leaf distances of the remaining regions
+	std::vector<int> leafDistances(numLabels + 1, 0);
+	for (unsigned int i = 0; i < _tiles.size(); i++) {
+
+		// local labels start at 1
+		std::copy(
+				_tiles[i].leafDistances.begin() + 1,
+				_tiles[i].leafDistances.end(),
+				leafDistances.begin() + _tiles[i].labelOffset + 1);
+
+		std::vector<int>().swap(_tiles[i].leafDistances);
+	}
+
+	// the ids of the remaining regions in the merge history
+	std::vector<unsigned int> historyIds;
+	unsigned int              nextId = 0;
+
+	if (_keepMerges)
+		nextId = collectTileMerges(historyIds);
+
+	RegionStatistics                              statistics;
+	std::vector<IterativeRegionMerging::Boundary> boundaries;
+
+	collectRemainingRegions(image, statistics, boundaries);
+
+	// not needed anymore
+	_regions = vigra::MultiArray<2, int>();
+
+	IterativeRegionMerging finalMerging(statistics, boundaries, _shape, _mergeTree);
+	finalMerging.setInitialLeafDistances(leafDistances);
+
+	if (_keepMerges)
+		finalMerging.skipMergeTree();
+
+	std::vector<IterativeRegionMerging::Boundary>().swap(boundaries);
+
+	merging(finalMerging, image, std::numeric_limits<float>::max());
+
+	if (_keepMerges)
+		appendMerges(finalMerging.getMerges(), historyIds, nextId);
+}
+
+template <typename Superpixels>
+void
+TiledRegionMerging::createTileRegions(
+		Tile&                                 tile,
+		const vigra::MultiArrayView<2, float> image,
+		const Superpixels&                    superpixels) {
+
+	// the tile enlarged by the overlap
+	ShapeType begin = tile.begin - ShapeType(_tileOverlap);
+	ShapeType end   = tile.end   + ShapeType(_tileOverlap);
+	for (int d = 0; d < 2; d++) {
+
+		begin[d] = std::max(begin[d], static_cast<vigra::MultiArrayIndex>(0));
+		end[d]   = std::min(end[d], _shape[d]);
+	}
+
+	vigra::MultiArray<2, float> tileImage(image.subarray(begin, end));
+	vigra::MultiArray<2, int>   tileLabels(tileImage.shape());
+
+	superpixels(tileImage, tileLabels);
+
+	// crop to the tile
+	_regions.subarray(tile.begin, tile.end) = tileLabels.subarray(tile.begin - begin, tile.end - begin);
+
+	// the cropped tile might have lost labels, but the maximal label is still
+	// an upper bound
+	tile.numLabels = 0;
+	for (vigra::MultiArray<2, int>::iterator i = tileLabels.begin(); i != tileLabels.end(); i++)
+		tile.numLabels = std::max(tile.numLabels, *i);
+}
+
+template <typename Merging>
+void
+TiledRegionMerging::mergeTile(
+		Tile&                                 tile,
+		const vigra::MultiArrayView<2, float> image,
+		const Merging&                        merging) {
+
+	// local labels of this tile
+	vigra::MultiArray<2, int> tileRegions(_regions.subarray(tile.begin, tile.end));
+	for (vigra::MultiArray<2, int>::iterator i = tileRegions.begin(); i != tileRegions.end(); i++)
+		*i -= tile.labelOffset;
+
+	vigra::MultiArray<2, float> tileImage(image.subarray(tile.begin, tile.end));
+
+	// the merge tree of the tile is written to its part of the result
+	IterativeRegionMerging tileMerging(
+			tileRegions,
+			tileImage,
+			(_keepMerges ? vigra::MultiArrayView<2, int>() : _mergeTree.subarray(tile.begin*2, tile.end*2)));
+
+	if (_keepMerges) {
+
+		tileMerging.skipMergeTree();
+		tile.initialLabelOffset = tile.labelOffset;
+		tile.initialNumLabels   = tile.numLabels;
+	}
+
+	// regions at seams can only be merged in the final pass
+	std::vector<int> frozen = seamRegions(tile, tileRegions);
+	for (unsigned int i = 0; i < frozen.size(); i++)
+		tileMerging.freezeRegion(frozen[i]);
+
+	merging(tileMerging, tileImage, _tileMergeThreshold);
+
+	if (_keepMerges)
+		tile.merges = tileMerging.getMerges();
+
+	collectTileResult(tile, tileMerging, tileRegions);
+
+	_regions.subarray(tile.begin, tile.end) = tileRegions;
+}
+
+#endif // MULTI2CUT_MERGETREE_TILED_REGION_MERGING_H__
@@ -0,0 +1,24 @@
+#include <boost/thread.hpp>
+#include <util/ProgramOptions.h>
+#include "ParallelFor.h"
+
+namespace parallel {
+
+util::ProgramOption optionNumThreads(
+		util::_module           = "parallel",
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to use for parallel computations. The default (0) uses all available CPUs.",
+		util::_default_value    = 0);
+
+unsigned int
+getNumThreads() {
+
+	unsigned int numThreads = optionNumThreads.as<unsigned int>();
+
+	if (numThreads == 0)
+		numThreads = boost::thread::hardware_concurrency();
+
+	return std::max(numThreads, 1u);
+}
+
+} // namespace parallel
@@ -0,0 +1,134 @@
+#ifndef MULTI2CUT_PARALLEL_PARALLEL_FOR_H__
+#define MULTI2CUT_PARALLEL_PARALLEL_FOR_H__
+
+#include <algorithm>
+
+#include <boost/exception_ptr.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+#include "ThreadPool.h"
+
+namespace parallel {
+
+/**
+ * Get the number of threads to use for parallel loops, as set by the program
+ * option 'numThreads'.
+ */
+unsigned int getNumThreads();
+
+namespace detail {
+
+template <typename Functor>
+class ParallelForWorker {
+
+public:
+
+	ParallelForWorker(
+			const Functor&          functor,
+			unsigned int&           next,
+			unsigned int            end,
+			unsigned int            chunkSize,
+			boost::mutex&           mutex,
+			boost::exception_ptr&   exception) :
+		_functor(functor),
+		_next(next),
+		_end(end),
+		_chunkSize(chunkSize),
+		_mutex(mutex),
+		_exception(exception) {}
+
+	void operator()() {
+
+		try {
+
+			while (true) {
+
+				unsigned int begin, end;
+
+				{
+					boost::mutex::scoped_lock lock(_mutex);
+
+					if (_next >= _end || _exception)
+						return;
+
+					begin = _next;
+					end   = std::min(_end, begin + _chunkSize);
+					_next = end;
+				}
+
+				for (unsigned int i = begin; i < end; i++)
+					_functor(i);
+			}
+
+		} catch (...) {
+
+			boost::mutex::scoped_lock lock(_mutex);
+
+			if (!_exception)
+				_exception = boost::current_exception();
+		}
+	}
+
+private:
+
+	const Functor&         _functor;
+	unsigned int&          _next;
+	unsigned int           _end;
+	unsigned int           _chunkSize;
+	boost::mutex&          _mutex;
+	boost::exception_ptr&  _exception;
+};
+
+} // namespace detail
+
+/**
+ * Call functor(i) for each i in [begin, end), distributed over getNumThreads()
+ * threads of the ThreadPool. The indices are handed out in chunks of chunkSize 
+ * in increasing order. The functor has to be safe to call concurrently for 
+ * different indices. An exception thrown by the functor is rethrown in the 
+ * calling thread after all threads finished.
+ *
+ * Nested calls (from within a functor), and calls while the pool is busy with 
+ * another loop, run serially in the calling thread.
+ */
+template <typename Functor>
+void parallelFor(unsigned int begin, unsigned int end, const Functor& functor, unsigned int chunkSize = 1) {
+
+	if (end <= begin)
+		return;
+
+	chunkSize = std::max(chunkSize, 1u);
+
+	unsigned int numChunks  = (end - begin + chunkSize - 1)/chunkSize;
+	unsigned int numThreads = std::min(getNumThreads(), numChunks);
+
+	if (numThreads <= 1) {
+
+		for (unsigned int i = begin; i < end; i++)
+			functor(i);
+
+		return;
+	}
+
+	unsigned int         next = begin;
+	boost::mutex         mutex;
+	boost::exception_ptr exception;
+
+	detail::ParallelForWorker<Functor> worker(functor, next, end, chunkSize, mutex, exception);
+
+	if (!ThreadPool::getInstance().run(boost::ref(worker), numThreads)) {
+
+		for (unsigned int i = begin; i < end; i++)
+			functor(i);
+
+		return;
+	}
+
+	if (exception)
+		boost::rethrow_exception(exception);
+}
+
+} // namespace parallel
+
+#endif // MULTI2CUT_PARALLEL_PARALLEL_FOR_H__
+
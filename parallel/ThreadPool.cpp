@@ -0,0 +1,124 @@
+#include <algorithm>
+#include "ParallelFor.h"
+#include "ThreadPool.h"
+
+namespace parallel {
+
+ThreadPool*                      ThreadPool::Instance = 0;
+boost::once_flag                 ThreadPool::InstanceFlag = BOOST_ONCE_INIT;
+boost::thread_specific_ptr<bool> ThreadPool::IsWorker;
+
+ThreadPool&
+ThreadPool::getInstance() {
+
+	boost::call_once(InstanceFlag, &ThreadPool::createInstance);
+
+	return *Instance;
+}
+
+void
+ThreadPool::createInstance() {
+
+	// the pool lives until the end of the program
+	static ThreadPool pool(getNumThreads() - 1);
+
+	Instance = &pool;
+}
+
+ThreadPool::ThreadPool(unsigned int numWorkers) :
+	_numWorkers(numWorkers),
+	_generation(0),
+	_numRequested(0),
+	_numRunning(0),
+	_stop(false) {
+
+	for (unsigned int i = 0; i < _numWorkers; i++)
+		_workers.create_thread(boost::bind(&ThreadPool::work, this));
+}
+
+ThreadPool::~ThreadPool() {
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		_stop = true;
+		_jobAvailable.notify_all();
+	}
+
+	_workers.join_all();
+}
+
+bool
+ThreadPool::run(const boost::function<void()>& job, unsigned int numThreads) {
+
+	if (IsWorker.get())
+		return false;
+
+	boost::mutex::scoped_try_lock runLock(_runMutex);
+
+	if (!runLock)
+		return false;
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		_job = job;
+		_generation++;
+		_numRequested = std::min(std::max(numThreads, 1u) - 1, _numWorkers);
+
+		_jobAvailable.notify_all();
+	}
+
+	// the calling thread participates as well
+	job();
+
+	{
+		boost::mutex::scoped_lock lock(_mutex);
+
+		// workers that did not pick up the job yet are not needed anymore
+		_numRequested = 0;
+
+		while (_numRunning > 0)
+			_jobDone.wait(lock);
+
+		_job.clear();
+	}
+
+	return true;
+}
+
+void
+ThreadPool::work() {
+
+	IsWorker.reset(new bool(true));
+
+	unsigned int lastGeneration = 0;
+
+	boost::mutex::scoped_lock lock(_mutex);
+
+	while (true) {
+
+		while (!_stop && (_generation == lastGeneration || _numRequested == 0))
+			_jobAvailable.wait(lock);
+
+		if (_stop)
+			return;
+
+		lastGeneration = _generation;
+		_numRequested--;
+		_numRunning++;
+
+		boost::function<void()> job = _job;
+
+		lock.unlock();
+		job();
+		lock.lock();
+
+		_numRunning--;
+
+		if (_numRunning == 0)
+			_jobDone.notify_all();
+	}
+}
+
+} // namespace parallel
@@ -0,0 +1,84 @@
+#ifndef MULTI2CUT_PARALLEL_THREAD_POOL_H__
+#define MULTI2CUT_PARALLEL_THREAD_POOL_H__
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+namespace parallel {
+
+/**
+ * A process-wide pool of worker threads, used by parallelFor. The workers are 
+ * started on first use and wait for jobs until the program ends.
+ *
+ * A job is a function that is called concurrently by the calling thread and a 
+ * number of workers. The pool runs one job at a time. Jobs submitted while the 
+ * pool is busy, or from within a worker (i.e., nested parallel loops), are 
+ * rejected, and the caller is expected to do the work itself.
+ */
+class ThreadPool {
+
+public:
+
+	/**
+	 * Get the pool, which is created with getNumThreads() - 1 workers on the 
+	 * first call.
+	 */
+	static ThreadPool& getInstance();
+
+	~ThreadPool();
+
+	/**
+	 * Call job() on the calling thread and on up to numThreads - 1 workers, 
+	 * and return after all calls finished. Returns false without calling job, 
+	 * if the pool is busy or this is called from a worker.
+	 */
+	bool run(const boost::function<void()>& job, unsigned int numThreads);
+
+	/**
+	 * The number of worker threads, not counting the calling thread.
+	 */
+	unsigned int getNumWorkers() const { return _numWorkers; }
+
+private:
+
+	ThreadPool(unsigned int numWorkers);
+
+	static void createInstance();
+
+	void work();
+
+	unsigned int _numWorkers;
+
+	// held while a job is running
+	boost::mutex _runMutex;
+
+	// guards the members below
+	boost::mutex              _mutex;
+	boost::condition_variable _jobAvailable;
+	boost::condition_variable _jobDone;
+
+	boost::function<void()> _job;
+
+	// incremented for each job, such that a worker calls each job only once
+	unsigned int _generation;
+
+	// the number of workers that should still pick up the current job
+	unsigned int _numRequested;
+
+	// the number of workers currently calling the job
+	unsigned int _numRunning;
+
+	bool _stop;
+
+	boost::thread_group _workers;
+
+	static ThreadPool*      Instance;
+	static boost::once_flag InstanceFlag;
+
+	// set in worker threads, to detect nested jobs
+	static boost::thread_specific_ptr<bool> IsWorker;
+};
+
+} // namespace parallel
+
+#endif // MULTI2CUT_PARALLEL_THREAD_POOL_H__
@@ -1,11 +1,16 @@
+#include <algorithm>
+#include <limits>
+#include <boost/make_shared.hpp>
 #include "ComponentTreeConverter.h"
+#include "SliceIds.h"
 
 static logger::LogChannel componenttreeconverterlog("componenttreeconverterlog", "[ComponentTreeConverter] ");
 
 ComponentTreeConverter::ComponentTreeConverter(unsigned int section) :
 	_slices(new SlicesTree()),
 	_conflictSets(new ConflictSets()),
-	_section(section) {
+	_section(section),
+	_nextSliceId(0) {
 
 	registerInput(_componentTree, "component tree");
 	registerOutput(_slices, "slices");
@@ -15,17 +20,7 @@ ComponentTreeConverter::ComponentTreeConverter(unsigned int section) :
 unsigned int
 ComponentTreeConverter::getNextSliceId() {
 
-	unsigned int id;
-	
-	{
-		boost::mutex::scoped_lock lock(SliceIdMutex);
-
-		id = NextSliceId;
-
-		NextSliceId++;
-	}
-
-	return id;
+	return SliceIds::reserve(1);
 }
 
 void
@@ -43,10 +38,50 @@ ComponentTreeConverter::convert() {
 
 	_conflictSets->clear();
 
+	// reserve the ids for all slices at once
+
+	NodeCounter counter;
+	foreach (boost::shared_ptr<ComponentTree::Node> node, _componentTree->getRoot()->getChildren())
+		_componentTree->visit(node, counter);
+
+	_nextSliceId = SliceIds::reserve(counter.getNumNodes());
+
+	// the pixel list holds the pixels of all roots, which are disjoint
+
+	unsigned int numPixels = 0;
+	unsigned int maxX = 0;
+	unsigned int maxY = 0;
+
+	_minX = std::numeric_limits<unsigned int>::max();
+	_minY = std::numeric_limits<unsigned int>::max();
+
+	foreach (boost::shared_ptr<ComponentTree::Node> node, _componentTree->getRoot()->getChildren()) {
+
+		boost::shared_ptr<ConnectedComponent> component = node->getComponent();
+
+		const util::rect<unsigned int>& bb = component->getBoundingBox();
+
+		numPixels += component->getSize();
+
+		_minX = std::min(_minX, bb.minX);
+		_minY = std::min(_minY, bb.minY);
+		maxX  = std::max(maxX, bb.maxX);
+		maxY  = std::max(maxY, bb.maxY);
+	}
+
+	// allow for inclusive maxima of the bounding boxes
+	_width = (numPixels > 0 ? maxX - _minX + 1 : 0);
+
+	_pixelList = boost::make_shared<PixelList>(numPixels);
+	_added.assign(numPixels > 0 ? _width*(maxY - _minY + 1) : 0, 0);
+
 	// skip the fake root
 	foreach (boost::shared_ptr<ComponentTree::Node> node, _componentTree->getRoot()->getChildren())
 		_componentTree->visit(node, *this);
 
+	_pixelList.reset();
+	std::vector<char>().swap(_added);
+
 	LOG_DEBUG(componenttreeconverterlog) << "extracted " << _slices->size() << " slices" << std::endl;
 }
 
@@ -55,13 +90,19 @@ ComponentTreeConverter::visitNode(boost::shared_ptr<ComponentTree::Node> node) {
 
 	LOG_DEBUG(componenttreeconverterlog) << "visiting a node" << std::endl;
 
-	unsigned int sliceId = getNextSliceId();
+	unsigned int sliceId = _nextSliceId++;
 
 	_path.push_back(sliceId);
 
 	boost::shared_ptr<ConnectedComponent> component = node->getComponent();
 
-	_slices->addChild(boost::make_shared<Slice>(sliceId, _section, component));
+	boost::shared_ptr<Slice> slice = boost::make_shared<Slice>(sliceId, _section, component);
+
+	_slices->addChild(slice);
+
+	// the children's pixels will be added first
+	_pathSlices.push_back(slice);
+	_pathOffsets.push_back(_pixelList->size());
 
 	LOG_ALL(componenttreeconverterlog) << "extracted a slice at " << component->getCenter() << std::endl;
 
@@ -71,10 +112,29 @@ ComponentTreeConverter::visitNode(boost::shared_ptr<ComponentTree::Node> node) {
 }
 
 void
-ComponentTreeConverter::leaveNode(boost::shared_ptr<ComponentTree::Node>) {
+ComponentTreeConverter::leaveNode(boost::shared_ptr<ComponentTree::Node> node) {
 
 	LOG_DEBUG(componenttreeconverterlog) << "leaving a node" << std::endl;
 
+	// add the pixels that are not part of any child
+	foreach (const util::point<unsigned int>& pixel, node->getComponent()->getPixels()) {
+
+		unsigned int i = (pixel.y - _minY)*_width + (pixel.x - _minX);
+
+		if (_added[i])
+			continue;
+
+		_added[i] = 1;
+		_pixelList->add(pixel);
+	}
+
+	unsigned int offset = _pathOffsets.back();
+
+	_pathSlices.back()->setPixelRange(PixelRange(_pixelList, offset, _pixelList->size() - offset));
+
+	_pathSlices.pop_back();
+	_pathOffsets.pop_back();
+
 	_path.pop_back();
 
 	_slices->leaveChild();
@@ -85,13 +145,5 @@ ComponentTreeConverter::addConflictSet() {
 
 	LOG_ALL(componenttreeconverterlog) << "found a leaf node, creating a conflict set for it" << std::endl;
 
-	ConflictSet conflictSet;
-
-	foreach (unsigned int sliceId, _path)
-		conflictSet.addSlice(sliceId);
-
-	_conflictSets->add(conflictSet);
+	_conflictSets->add(_path.begin(), _path.end());
 }
-
-unsigned int ComponentTreeConverter::NextSliceId = 0;
-boost::mutex ComponentTreeConverter::SliceIdMutex;
@@ -2,18 +2,20 @@
 #define SOPNET_COMPONENT_TREE_CONVERTER_H__
 
 #include <deque>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
-#include <boost/thread.hpp>
 
 #include <pipeline/all.h>
 #include <imageprocessing/ComponentTree.h>
+#include <imageprocessing/PixelList.h>
 #include "ConflictSets.h"
 #include "SlicesTree.h"
 
 /**
  * Converts a component tree into a set of Slices and creates conflict sets for 
- * conflicting slices.
+ * conflicting slices. The pixels of the tree are permuted into one pixel list, 
+ * in which each slice is given its PixelRange.
  *
  * Input:
  *
@@ -51,15 +53,31 @@ public:
 
 	void leaveNode(boost::shared_ptr<ComponentTree::Node> node);
 
+	/**
+	 * Get a new slice id, unique among all slices of all sections.
+	 */
+	static unsigned int getNextSliceId();
+
 private:
 
-	void addConflictSet();
+	class NodeCounter : public ComponentTree::Visitor {
 
-	static unsigned int getNextSliceId();
+	public:
+
+		NodeCounter() : _numNodes(0) {}
+
+		void visitNode(boost::shared_ptr<ComponentTree::Node>) { _numNodes++; }
+
+		void leaveNode(boost::shared_ptr<ComponentTree::Node>) {}
 
-	static unsigned int NextSliceId;
+		unsigned int getNumNodes() const { return _numNodes; }
 
-	static boost::mutex SliceIdMutex;
+	private:
+
+		unsigned int _numNodes;
+	};
+
+	void addConflictSet();
 
 	void updateOutputs();
 
@@ -72,6 +90,23 @@ private:
 	// the path to the currently visited component
 	std::deque<unsigned int> _path;
 
+	// the slices on the path and the offsets of their ranges
+	std::vector<boost::shared_ptr<Slice> > _pathSlices;
+	std::vector<unsigned int>              _pathOffsets;
+
+	// the permuted pixels of the component tree
+	boost::shared_ptr<PixelList> _pixelList;
+
+	// the pixels already added to _pixelList, within the bounding box of the 
+	// roots starting at (_minX, _minY)
+	std::vector<char> _added;
+	unsigned int      _minX;
+	unsigned int      _minY;
+	unsigned int      _width;
+
+	// the next id of the range reserved for the component tree
+	unsigned int _nextSliceId;
+
 	unsigned int _section;
 };
 
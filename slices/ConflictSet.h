@@ -1,11 +1,12 @@
 #ifndef SOPNET_SLICES_CONFLICT_SET_H__
 #define SOPNET_SLICES_CONFLICT_SET_H__
 
-#include <set>
+#include <algorithm>
+#include <vector>
 
 /**
  * Collection of slice ids that are in conflict, i.e., only one of them can be 
- * chosen at the same time.
+ * chosen at the same time. The ids are kept sorted and without duplicates.
  */
 class ConflictSet {
 
@@ -13,14 +14,17 @@ public:
 
 	void addSlice(unsigned int sliceId) {
 
-		_sliceIds.insert(sliceId);
+		std::vector<unsigned int>::iterator i = std::lower_bound(_sliceIds.begin(), _sliceIds.end(), sliceId);
+
+		if (i == _sliceIds.end() || *i != sliceId)
+			_sliceIds.insert(i, sliceId);
 	}
 
 	void removeSlice(unsigned int sliceId) {
 
-		std::set<unsigned int>::iterator i = _sliceIds.find(sliceId);
+		std::vector<unsigned int>::iterator i = std::lower_bound(_sliceIds.begin(), _sliceIds.end(), sliceId);
 
-		if (i != _sliceIds.end())
+		if (i != _sliceIds.end() && *i == sliceId)
 			_sliceIds.erase(i);
 	}
 
@@ -29,15 +33,52 @@ public:
 		_sliceIds.clear();
 	}
 
-	const std::set<unsigned int>& getSlices() const {
+	const std::vector<unsigned int>& getSlices() const {
 
 		return _sliceIds;
 	}
 
 private:
 
-	std::set<unsigned int> _sliceIds;
+	std::vector<unsigned int> _sliceIds;
 };
 
-#endif // SOPNET_SLICES_CONFLICT_SET_H__
+/**
+ * A read-only view on the sorted slice ids of a conflict set stored in 
+ * ConflictSets.
+ */
+class ConflictSetView {
+
+public:
+
+	typedef const unsigned int* iterator;
+	typedef const unsigned int* const_iterator;
+
+	ConflictSetView(const unsigned int* begin, const unsigned int* end) :
+		_begin(begin),
+		_end(end) {}
+
+	const_iterator begin() const { return _begin; }
+
+	const_iterator end() const { return _end; }
 
+	unsigned int size() const { return _end - _begin; }
+
+	bool contains(unsigned int sliceId) const {
+
+		return std::binary_search(_begin, _end, sliceId);
+	}
+
+	/**
+	 * For compatibility with ConflictSet, the view itself is the range of 
+	 * slice ids.
+	 */
+	const ConflictSetView& getSlices() const { return *this; }
+
+private:
+
+	const unsigned int* _begin;
+	const unsigned int* _end;
+};
+
+#endif // SOPNET_SLICES_CONFLICT_SET_H__
@@ -1,6 +1,8 @@
 #ifndef SOPNET_SLICES_CONFLICT_SETS_H__
 #define SOPNET_SLICES_CONFLICT_SETS_H__
 
+#include <algorithm>
+#include <iterator>
 #include <vector>
 #include <pipeline/Data.h>
 
@@ -8,59 +10,156 @@
 
 /**
  * Collection of slice conflict sets.
+ *
+ * The slice ids of all sets are stored in a single array, where each set is a 
+ * consecutive range of sorted ids without duplicates (compressed sparse row 
+ * layout). Iterating yields a ConflictSetView for each set.
  */
 class ConflictSets : public pipeline::Data {
 
 public:
 
-	typedef std::vector<ConflictSet>::iterator       iterator;
-	typedef std::vector<ConflictSet>::const_iterator const_iterator;
+	class const_iterator : public std::iterator<
+			std::forward_iterator_tag,
+			ConflictSetView,
+			std::ptrdiff_t,
+			const ConflictSetView*,
+			ConflictSetView> {
+
+	public:
+
+		const_iterator(const ConflictSets& conflictSets, unsigned int index) :
+			_conflictSets(&conflictSets),
+			_index(index) {}
+
+		ConflictSetView operator*() const { return (*_conflictSets)[_index]; }
+
+		const_iterator& operator++() {
+
+			_index++;
+			return *this;
+		}
+
+		const_iterator operator++(int) {
+
+			const_iterator i = *this;
+			_index++;
+			return i;
+		}
+
+		bool operator==(const const_iterator& other) const { return _index == other._index; }
+
+		bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+	private:
+
+		const ConflictSets* _conflictSets;
+		unsigned int        _index;
+	};
+
+	typedef const_iterator iterator;
+
+	ConflictSets() :
+		_offsets(1, 0) {}
 
 	void add(const ConflictSet& conflictSet) {
 
-		_conflictSets.push_back(conflictSet);
+		add(conflictSet.getSlices().begin(), conflictSet.getSlices().end());
+	}
+
+	/**
+	 * Add a conflict set with the slice ids in [begin, end), which do not have 
+	 * to be sorted or unique.
+	 */
+	template <typename Iterator>
+	void add(Iterator begin, Iterator end) {
+
+		unsigned int first = _sliceIds.size();
+
+		_sliceIds.insert(_sliceIds.end(), begin, end);
+
+		finishSet(first);
 	}
 
 	void addAll(const ConflictSets& conflictSets) {
 
-		foreach (const ConflictSet& conflictSet, conflictSets)
-			add(conflictSet);
+		unsigned int shift = _sliceIds.size();
+
+		_sliceIds.insert(_sliceIds.end(), conflictSets._sliceIds.begin(), conflictSets._sliceIds.end());
+
+		_offsets.reserve(_offsets.size() + conflictSets.size());
+		for (unsigned int i = 1; i < conflictSets._offsets.size(); i++)
+			_offsets.push_back(shift + conflictSets._offsets[i]);
 	}
 
-	std::vector<ConflictSet>::iterator begin() {
+	/**
+	 * Add all conflict sets of the given collection, with each slice id 
+	 * replaced by idMap[id]. Ids that are mapped to the same id are merged.
+	 */
+	template <typename IdMap>
+	void merge(const ConflictSets& conflictSets, const IdMap& idMap) {
+
+		_sliceIds.reserve(_sliceIds.size() + conflictSets._sliceIds.size());
+		_offsets.reserve(_offsets.size() + conflictSets.size());
+
+		for (unsigned int i = 0; i < conflictSets.size(); i++) {
+
+			unsigned int first = _sliceIds.size();
+
+			foreach (unsigned int sliceId, conflictSets[i])
+				_sliceIds.push_back(idMap[sliceId]);
 
-		return _conflictSets.begin();
+			finishSet(first);
+		}
 	}
 
-	std::vector<ConflictSet>::const_iterator begin() const {
+	ConflictSetView operator[](unsigned int i) const {
 
-		return _conflictSets.begin();
+		const unsigned int* sliceIds = (_sliceIds.empty() ? 0 : &_sliceIds[0]);
+
+		return ConflictSetView(sliceIds + _offsets[i], sliceIds + _offsets[i + 1]);
 	}
 
-	std::vector<ConflictSet>::iterator end() {
+	const_iterator begin() const {
 
-		return _conflictSets.end();
+		return const_iterator(*this, 0);
 	}
 
-	std::vector<ConflictSet>::const_iterator end() const {
+	const_iterator end() const {
 
-		return _conflictSets.end();
+		return const_iterator(*this, size());
 	}
 
 	void clear() {
 
-		_conflictSets.clear();
+		_offsets.assign(1, 0);
+		_sliceIds.clear();
 	}
 
 	unsigned int size() const {
 
-		return _conflictSets.size();
+		return _offsets.size() - 1;
 	}
 
 private:
 
-	std::vector<ConflictSet> _conflictSets;
+	/**
+	 * Sort and unique the ids of the last set, which start at first, and close 
+	 * the set.
+	 */
+	void finishSet(unsigned int first) {
+
+		std::sort(_sliceIds.begin() + first, _sliceIds.end());
+		_sliceIds.erase(std::unique(_sliceIds.begin() + first, _sliceIds.end()), _sliceIds.end());
+
+		_offsets.push_back(_sliceIds.size());
+	}
+
+	// for each set, the index of its first slice id, and one past the end
+	std::vector<unsigned int> _offsets;
+
+	// the slice ids of all sets
+	std::vector<unsigned int> _sliceIds;
 };
 
 #endif // SOPNET_SLICES_CONFLICT_SETS_H__
-
@@ -0,0 +1,233 @@
+#include <boost/make_shared.hpp>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include <imageprocessing/ConnectedComponent.h>
+#include <imageprocessing/Image.h>
+#include <imageprocessing/PixelList.h>
+#include "MergeHistoryConverter.h"
+#include "SliceIds.h"
+
+static logger::LogChannel mergehistoryconverterlog("mergehistoryconverterlog", "[MergeHistoryConverter] ");
+
+extern util::ProgramOption optionMinSliceSize;
+extern util::ProgramOption optionMaxSliceSize;
+extern util::ProgramOption optionMaxSliceMerges;
+
+MergeHistoryConverter::MergeHistoryConverter(unsigned int section, bool downsample) :
+	_section(section),
+	_downsample(downsample) {}
+
+void
+MergeHistoryConverter::convert(
+		const MergeHistory& mergeHistory,
+		SlicesTree&         slices,
+		ConflictSets&       conflictSets) {
+
+	LOG_DEBUG(mergehistoryconverterlog) << "converting merge history to slices..." << std::endl;
+
+	slices.clear();
+	conflictSets.clear();
+
+	const vigra::MultiArray<2, int>& initialRegions = mergeHistory.getInitialRegions();
+	const MergeHistory::MergesType&  merges         = mergeHistory.getMerges();
+
+	// get the number of node ids
+
+	int numNodes = 0;
+	for (vigra::MultiArray<2, int>::const_iterator i = initialRegions.begin(); i != initialRegions.end(); i++) {
+
+		if (*i < 0)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"merge history contains negative region label " << *i);
+
+		numNodes = std::max(numNodes, *i + 1);
+	}
+	for (MergeHistory::MergesType::const_iterator i = merges.begin(); i != merges.end(); i++)
+		numNodes = std::max(numNodes, static_cast<int>(i->parent) + 1);
+
+	// reconstruct the merge tree, the parents have larger ids than their
+	// children
+
+	std::vector<unsigned int> size(numNodes, 0);
+	std::vector<int>          parent(numNodes, -1);
+	std::vector<int>          leafDistance(numNodes, 0);
+	std::vector<std::pair<int, int> > children(numNodes, std::make_pair(-1, -1));
+
+	for (vigra::MultiArray<2, int>::const_iterator i = initialRegions.begin(); i != initialRegions.end(); i++)
+		size[*i]++;
+
+	for (MergeHistory::MergesType::const_iterator i = merges.begin(); i != merges.end(); i++) {
+
+		if (i->parent <= std::max(i->a, i->b) || parent[i->a] != -1 || parent[i->b] != -1)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"invalid merge of " << i->a << " and " << i->b << " into " << i->parent);
+
+		parent[i->a] = i->parent;
+		parent[i->b] = i->parent;
+		children[i->parent] = std::make_pair(i->a, i->b);
+		size[i->parent] = size[i->a] + size[i->b];
+		leafDistance[i->parent] = std::max(leafDistance[i->a], leafDistance[i->b]) + 1;
+	}
+
+	// arrange the pixels such that the pixels of each region are contiguous:
+	// the roots get consecutive ranges, and each parent's range is split
+	// among its children
+
+	std::vector<unsigned int> begin(numNodes, 0);
+
+	unsigned int numPixels = 0;
+	for (int n = 0; n < numNodes; n++)
+		if (parent[n] == -1) {
+
+			begin[n]   = numPixels;
+			numPixels += size[n];
+		}
+
+	for (int n = numNodes - 1; n >= 0; n--)
+		if (children[n].first >= 0) {
+
+			begin[children[n].first]  = begin[n];
+			begin[children[n].second] = begin[n] + size[children[n].first];
+		}
+
+	std::vector<util::point<unsigned int> > pixels(numPixels);
+	std::vector<unsigned int>               next(begin);
+
+	for (int y = 0; y < initialRegions.height(); y++)
+		for (int x = 0; x < initialRegions.width(); x++)
+			pixels[next[initialRegions(x, y)]++] = util::point<unsigned int>(x, y);
+
+	boost::shared_ptr<PixelList> pixelList = boost::make_shared<PixelList>(numPixels);
+	for (unsigned int i = 0; i < numPixels; i++)
+		pixelList->add(pixels[i]);
+	std::vector<util::point<unsigned int> >().swap(pixels);
+
+	// find the regions that become slices
+
+	unsigned int minSize   = optionMinSliceSize.as<unsigned int>();
+	unsigned int maxSize   = optionMaxSliceSize.as<unsigned int>();
+	int          maxHeight = optionMaxSliceMerges.as<int>();
+
+	std::vector<char> isSlice(numNodes);
+	for (int n = 0; n < numNodes; n++)
+		isSlice[n] = (size[n] > 0 && size[n] >= minSize && size[n] <= maxSize);
+
+	// the closest ancestor of each region that is a slice
+	std::vector<int> sliceParent(numNodes, -1);
+	for (int n = numNodes - 1; n >= 0; n--)
+		if (parent[n] != -1)
+			sliceParent[n] = (isSlice[parent[n]] ? parent[n] : sliceParent[parent[n]]);
+
+	std::vector<std::vector<int> > sliceChildren(numNodes);
+	for (int n = 0; n < numNodes; n++)
+		if (isSlice[n] && sliceParent[n] != -1)
+			sliceChildren[sliceParent[n]].push_back(n);
+
+	// skip single children, parents are visited before their children
+	if (_downsample)
+		for (int n = numNodes - 1; n >= 0; n--) {
+
+			if (!isSlice[n])
+				continue;
+
+			while (sliceChildren[n].size() == 1) {
+
+				int child = sliceChildren[n][0];
+
+				isSlice[child] = false;
+				sliceChildren[n].swap(sliceChildren[child]);
+				std::vector<int>().swap(sliceChildren[child]);
+			}
+		}
+
+	// limit the height of the slice tree, children are visited before their
+	// parents
+	std::vector<int> height(numNodes, 0);
+	for (int n = 0; n < numNodes; n++) {
+
+		if (!isSlice[n])
+			continue;
+
+		for (unsigned int i = 0; i < sliceChildren[n].size(); i++)
+			height[n] = std::max(height[n], height[sliceChildren[n][i]] + 1);
+
+		if (height[n] > maxHeight)
+			isSlice[n] = false;
+	}
+
+	std::vector<char> isRoot(isSlice);
+	for (int n = 0; n < numNodes; n++)
+		if (isSlice[n])
+			for (unsigned int i = 0; i < sliceChildren[n].size(); i++)
+				isRoot[sliceChildren[n][i]] = false;
+
+	// reserve the ids for all slices at once
+
+	unsigned int numSlices = 0;
+	for (int n = 0; n < numNodes; n++)
+		if (isSlice[n])
+			numSlices++;
+
+	unsigned int nextSliceId = SliceIds::reserve(numSlices);
+
+	// create the slices and conflict sets in depth-first order
+
+	std::vector<std::pair<int, unsigned int> > stack;
+	std::vector<unsigned int>                  path;
+
+	for (int root = 0; root < numNodes; root++) {
+
+		if (!isRoot[root])
+			continue;
+
+		stack.push_back(std::make_pair(root, 0u));
+
+		while (!stack.empty()) {
+
+			int          n     = stack.back().first;
+			unsigned int child = stack.back().second;
+
+			// entering n
+			if (child == 0) {
+
+				unsigned int sliceId = nextSliceId++;
+
+				path.push_back(sliceId);
+
+				boost::shared_ptr<ConnectedComponent> component =
+						boost::make_shared<ConnectedComponent>(
+								boost::shared_ptr<Image>(),
+								leafDistance[n],
+								pixelList,
+								pixelList->begin() + begin[n],
+								pixelList->begin() + begin[n] + size[n]);
+
+				boost::shared_ptr<Slice> slice = boost::make_shared<Slice>(sliceId, _section, component);
+				slice->setPixelRange(PixelRange(pixelList, begin[n], size[n]));
+
+				slices.addChild(slice);
+
+				// for leafs
+				if (sliceChildren[n].empty())
+					conflictSets.add(path.begin(), path.end());
+			}
+
+			if (child < sliceChildren[n].size()) {
+
+				stack.back().second++;
+				stack.push_back(std::make_pair(sliceChildren[n][child], 0u));
+
+			} else {
+
+				path.pop_back();
+				slices.leaveChild();
+				stack.pop_back();
+			}
+		}
+	}
+
+	LOG_DEBUG(mergehistoryconverterlog) << "extracted " << slices.size() << " slices" << std::endl;
+}
@@ -0,0 +1,43 @@
+#ifndef MULTI2CUT_SLICES_MERGE_HISTORY_CONVERTER_H__
+#define MULTI2CUT_SLICES_MERGE_HISTORY_CONVERTER_H__
+
+#include <mergetree/MergeHistory.h>
+#include "ConflictSets.h"
+#include "SlicesTree.h"
+
+/**
+ * Converts a merge history into a tree of slices and the conflict sets of its
+ * leaf-to-root paths, without rasterizing the merge tree into an image and
+ * extracting its component tree.
+ *
+ * Regions outside the size limits optionMinSliceSize and optionMaxSliceSize
+ * are skipped, single children are skipped (if downsample is set), and only
+ * the lowest optionMaxSliceMerges+1 levels of the remaining tree are kept.
+ *
+ * The sizes are counted in pixels of the initial regions. A SliceExtractor on
+ * the merge-tree image of the same history applies the limits to the
+ * components of that (twice as large) image instead, so the two do not
+ * generally find the same slices.
+ *
+ * The pixels of all slices share one pixel list, in which each region's
+ * pixels are contiguous.
+ */
+class MergeHistoryConverter {
+
+public:
+
+	MergeHistoryConverter(unsigned int section, bool downsample = true);
+
+	void convert(
+			const MergeHistory& mergeHistory,
+			SlicesTree&         slices,
+			ConflictSets&       conflictSets);
+
+private:
+
+	unsigned int _section;
+
+	bool _downsample;
+};
+
+#endif // MULTI2CUT_SLICES_MERGE_HISTORY_CONVERTER_H__
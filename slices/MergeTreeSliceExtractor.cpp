@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <limits>
+#include <boost/lexical_cast.hpp>
+#include <util/Logger.h>
+#include <mergetree/IterativeRegionMerging.h>
+#include <mergetree/MergeHistory.h>
+#include <mergetree/Merging.h>
+#include <mergetree/Superpixels.h>
+#include <parallel/ParallelFor.h>
+#include "MergeHistoryConverter.h"
+#include "MergeTreeSliceExtractor.h"
+#include "SliceIds.h"
+
+static logger::LogChannel mergetreesliceextractorlog("mergetreesliceextractorlog", "[MergeTreeSliceExtractor] ");
+
+MergeTreeSliceExtractor::MergeTreeSliceExtractor(unsigned int section, unsigned int ensembleSize) :
+	_slices(std::max(ensembleSize, 1u)),
+	_conflictSets(std::max(ensembleSize, 1u)),
+	_section(section),
+	_ensembleSize(ensembleSize) {
+
+	registerInput(_boundaries, "boundaries");
+
+	for (unsigned int i = 0; i < _slices.size(); i++) {
+
+		_slices[i]       = new SlicesTree();
+		_conflictSets[i] = new ConflictSets();
+
+		std::string suffix = (_ensembleSize == 0 ? "" : " " + boost::lexical_cast<std::string>(i));
+
+		registerOutput(_slices[i], "slices" + suffix);
+		registerOutput(_conflictSets[i], "conflict sets" + suffix);
+	}
+}
+
+void
+MergeTreeSliceExtractor::updateOutputs() {
+
+	vigra::MultiArray<2, float> boundaries(*_boundaries);
+	vigra::MultiArray<2, int>   initialRegions(boundaries.shape());
+
+	unsigned int maxLabel = Superpixels()(boundaries, initialRegions);
+
+	LOG_DEBUG(mergetreesliceextractorlog) << "found " << maxLabel << " initial regions" << std::endl;
+
+	if (_ensembleSize == 0)
+		extractSingle(boundaries, initialRegions);
+	else
+		extractEnsemble(boundaries, initialRegions);
+}
+
+void
+MergeTreeSliceExtractor::extractSingle(
+		vigra::MultiArrayView<2, float> boundaries,
+		vigra::MultiArrayView<2, int>   initialRegions) {
+
+	IterativeRegionMerging merging(initialRegions, boundaries);
+
+	Merging()(merging, boundaries, std::numeric_limits<float>::max());
+
+	MergeHistory mergeHistory(initialRegions, merging.getMerges());
+
+	MergeHistoryConverter converter(_section);
+	converter.convert(mergeHistory, *_slices[0], *_conflictSets[0]);
+}
+
+void
+MergeTreeSliceExtractor::extractEnsemble(
+		vigra::MultiArrayView<2, float> boundaries,
+		vigra::MultiArrayView<2, int>   initialRegions) {
+
+	MergeTreeEnsemble ensemble(boundaries, initialRegions);
+
+	ensemble.createMergeTrees(_ensembleSize);
+
+	parallel::parallelFor(0, ensemble.size(), TreeConverter(ensemble, initialRegions, *this));
+
+	// the trees reserved their ids in any order, assign them in the order of 
+	// the trees
+	for (unsigned int i = 0; i < ensemble.size(); i++)
+		SliceIds::renumber(*_slices[i], *_conflictSets[i]);
+}
+
+void
+MergeTreeSliceExtractor::TreeConverter::operator()(unsigned int i) const {
+
+	MergeHistory mergeHistory(_initialRegions, _ensemble.getMerges(i));
+
+	MergeHistoryConverter converter(_extractor._section);
+	converter.convert(mergeHistory, *_extractor._slices[i], *_extractor._conflictSets[i]);
+}
@@ -0,0 +1,107 @@
+#ifndef MULTI2CUT_SLICES_MERGE_TREE_SLICE_EXTRACTOR_H__
+#define MULTI2CUT_SLICES_MERGE_TREE_SLICE_EXTRACTOR_H__
+
+#include <vector>
+#include <pipeline/all.h>
+#include <vigra/multi_array.hxx>
+#include <imageprocessing/Image.h>
+#include <mergetree/MergeTreeEnsemble.h>
+#include "ConflictSets.h"
+#include "SlicesTree.h"
+
+/**
+ * Creates a merge tree for a boundary image in memory and converts it into 
+ * slices and conflict sets, without writing and reading a merge-tree image. 
+ * The initial regions and the merging are configured by the same program 
+ * options as for merge_tree.
+ *
+ * If an ensemble size is given, that many merge trees with randomly perturbed 
+ * scores are created concurrently (see MergeTreeEnsemble), and the outputs 
+ * are provided for each tree i as "slices i" and "conflict sets i". The trees 
+ * are converted into slices concurrently as well, the slice ids are assigned 
+ * in the order of the trees afterwards.
+ *
+ * Input:
+ *
+ * <table>
+ * <tr>
+ *   <td>"boundaries"</td>
+ *   <td>(Image)</td>
+ *   <td>The boundary prediction image to compute the merge tree for.</td>
+ * </tr>
+ * </table>
+ *
+ * Outputs:
+ *
+ * <table>
+ * <tr>
+ *   <td>"slices"</td>
+ *   <td>(SlicesTree)</td>
+ *   <td>All slices found in the merge tree.</td>
+ * </tr>
+ * <tr>
+ *   <td>"conflict sets"</td>
+ *   <td>(ConflictSets)</td>
+ *   <td>Conflict sets preventing conflicting slices to be picked at the
+ *   same time.</td>
+ * </tr>
+ * </table>
+ */
+class MergeTreeSliceExtractor : public pipeline::SimpleProcessNode<> {
+
+public:
+
+	/**
+	 * Create a new merge-tree slice extractor for the given section.
+	 *
+	 * @param ensembleSize
+	 *              The number of randomly perturbed merge trees to create. If 
+	 *              0, a single merge tree without perturbation is created.
+	 */
+	MergeTreeSliceExtractor(unsigned int section, unsigned int ensembleSize = 0);
+
+private:
+
+	class TreeConverter {
+
+	public:
+
+		TreeConverter(
+				MergeTreeEnsemble&            ensemble,
+				vigra::MultiArrayView<2, int> initialRegions,
+				MergeTreeSliceExtractor&      extractor) :
+			_ensemble(ensemble),
+			_initialRegions(initialRegions),
+			_extractor(extractor) {}
+
+		void operator()(unsigned int i) const;
+
+	private:
+
+		MergeTreeEnsemble&            _ensemble;
+		vigra::MultiArrayView<2, int> _initialRegions;
+		MergeTreeSliceExtractor&      _extractor;
+	};
+
+	void updateOutputs();
+
+	void extractSingle(
+			vigra::MultiArrayView<2, float> boundaries,
+			vigra::MultiArrayView<2, int>   initialRegions);
+
+	void extractEnsemble(
+			vigra::MultiArrayView<2, float> boundaries,
+			vigra::MultiArrayView<2, int>   initialRegions);
+
+	pipeline::Input<Image> _boundaries;
+
+	// one output per merge tree
+	std::vector<pipeline::Output<SlicesTree> >   _slices;
+	std::vector<pipeline::Output<ConflictSets> > _conflictSets;
+
+	unsigned int _section;
+
+	unsigned int _ensembleSize;
+};
+
+#endif // MULTI2CUT_SLICES_MERGE_TREE_SLICE_EXTRACTOR_H__
@@ -0,0 +1,61 @@
+#ifndef MULTI2CUT_SLICES_PIXEL_RANGE_H__
+#define MULTI2CUT_SLICES_PIXEL_RANGE_H__
+
+#include <boost/shared_ptr.hpp>
+#include <imageprocessing/PixelList.h>
+
+/**
+ * A contiguous range [offset, offset + size) of a pixel list that is shared 
+ * between the slices of a tree. The pixel list is a permutation of the pixels 
+ * of the tree's roots, in which the pixels of each node are contiguous and 
+ * contain the ranges of the node's children. The MergeHistoryConverter and the 
+ * ComponentTreeConverter set the ranges of the slices they extract.
+ *
+ * Reductions over a node's pixels can therefore be computed for all nodes at 
+ * once from prefix sums over the shared pixel list.
+ */
+class PixelRange {
+
+public:
+
+	typedef PixelList::const_iterator const_iterator;
+
+	PixelRange() :
+		_offset(0),
+		_size(0) {}
+
+	PixelRange(
+			boost::shared_ptr<const PixelList> pixelList,
+			unsigned int                       offset,
+			unsigned int                       size) :
+		_pixelList(pixelList),
+		_offset(offset),
+		_size(size) {}
+
+	/**
+	 * True if this range refers to a shared pixel list.
+	 */
+	bool valid() const { return _pixelList.get() != 0; }
+
+	const_iterator begin() const { return _pixelList->begin() + _offset; }
+
+	const_iterator end() const { return _pixelList->begin() + _offset + _size; }
+
+	unsigned int offset() const { return _offset; }
+
+	unsigned int size() const { return _size; }
+
+	/**
+	 * The pixel list this range refers to.
+	 */
+	boost::shared_ptr<const PixelList> getPixelList() const { return _pixelList; }
+
+private:
+
+	boost::shared_ptr<const PixelList> _pixelList;
+
+	unsigned int _offset;
+	unsigned int _size;
+};
+
+#endif // MULTI2CUT_SLICES_PIXEL_RANGE_H__
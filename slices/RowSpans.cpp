@@ -0,0 +1,297 @@
+#include <algorithm>
+#include "RowSpans.h"
+
+namespace {
+
+// order pixels by row, then by column
+struct RowMajor {
+
+	bool operator()(const util::point<int>& a, const util::point<int>& b) const {
+
+		return (a.y < b.y || (a.y == b.y && a.x < b.x));
+	}
+};
+
+// the number of pixels in the intersection of two sorted lists of disjoint 
+// spans, the second shifted by dx
+unsigned int
+intersectRows(
+		const int* begins1, const int* ends1, unsigned int n1,
+		const int* begins2, const int* ends2, unsigned int n2,
+		int dx) {
+
+	unsigned int size = 0;
+	unsigned int i = 0, j = 0;
+
+	while (i < n1 && j < n2) {
+
+		int begin2 = begins2[j] + dx;
+		int end2   = ends2[j] + dx;
+
+		int overlap = std::min(ends1[i], end2) - std::max(begins1[i], begin2);
+		size += std::max(overlap, 0);
+
+		// advance the span that ends first
+		bool advance1 = (ends1[i] <= end2);
+		i += advance1;
+		j += !advance1;
+	}
+
+	return size;
+}
+
+// the SplitMix64 finalizer
+boost::uint64_t
+mix(boost::uint64_t x) {
+
+	x += UINT64_C(0x9e3779b97f4a7c15);
+	x  = (x ^ (x >> 30))*UINT64_C(0xbf58476d1ce4e5b9);
+	x  = (x ^ (x >> 27))*UINT64_C(0x94d049bb133111eb);
+
+	return x ^ (x >> 31);
+}
+
+} // anonymous namespace
+
+RowSpans::RowSpans() :
+	_firstRow(0),
+	_rowOffsets(1, 0),
+	_size(0),
+	_boundingBox(0, 0, 0, 0),
+	_center(0, 0) {}
+
+void
+RowSpans::create(std::vector<util::point<int> >& pixels) {
+
+	_firstRow = 0;
+	_rowOffsets.assign(1, 0);
+	_begins.clear();
+	_ends.clear();
+
+	if (pixels.empty()) {
+
+		finish();
+		return;
+	}
+
+	std::sort(pixels.begin(), pixels.end(), RowMajor());
+
+	_firstRow = pixels.front().y;
+	int lastRow = pixels.back().y;
+
+	_rowOffsets.assign(lastRow - _firstRow + 2, 0);
+
+	for (unsigned int i = 0; i < pixels.size(); i++) {
+
+		const util::point<int>& p = pixels[i];
+
+		// duplicates are ignored
+		if (i > 0 && pixels[i - 1] == p)
+			continue;
+
+		// continue the current span, or start a new one
+		if (i > 0 && pixels[i - 1].y == p.y && _ends.back() == p.x) {
+
+			_ends.back()++;
+
+		} else {
+
+			_begins.push_back(p.x);
+			_ends.push_back(p.x + 1);
+			_rowOffsets[p.y - _firstRow + 1]++;
+		}
+	}
+
+	// prefix sum of the number of spans per row
+	for (unsigned int row = 1; row < _rowOffsets.size(); row++)
+		_rowOffsets[row] += _rowOffsets[row - 1];
+
+	finish();
+}
+
+void
+RowSpans::finish() {
+
+	_size = 0;
+
+	if (_begins.empty()) {
+
+		_boundingBox = util::rect<int>(0, 0, 0, 0);
+		_center      = util::point<double>(0, 0);
+		return;
+	}
+
+	int minX = _begins[0];
+	int maxX = _ends[0];
+
+	// sums of the pixel coordinates
+	double sumX = 0;
+	double sumY = 0;
+
+	for (int row = 0; row < numRows(); row++)
+		for (unsigned int i = rowBegin(row); i < rowEnd(row); i++) {
+
+			int length = _ends[i] - _begins[i];
+
+			_size += length;
+			minX   = std::min(minX, _begins[i]);
+			maxX   = std::max(maxX, _ends[i]);
+
+			sumX += 0.5*length*(_begins[i] + _ends[i] - 1);
+			sumY += static_cast<double>(length)*(_firstRow + row);
+		}
+
+	_boundingBox = util::rect<int>(minX, _firstRow, maxX, _firstRow + numRows());
+	_center      = util::point<double>(sumX/_size, sumY/_size);
+}
+
+void
+RowSpans::translate(const util::point<int>& offset) {
+
+	if (_size == 0)
+		return;
+
+	_firstRow += offset.y;
+
+	for (unsigned int i = 0; i < _begins.size(); i++) {
+
+		_begins[i] += offset.x;
+		_ends[i]   += offset.x;
+	}
+
+	finish();
+}
+
+unsigned int
+RowSpans::intersectionSize(const RowSpans& other, const util::point<int>& offset) const {
+
+	if (_size == 0 || other._size == 0)
+		return 0;
+
+	// the rows of this that other covers after translation
+	int firstRow = std::max(_firstRow, other._firstRow + offset.y);
+	int endRow   = std::min(_firstRow + numRows(), other._firstRow + other.numRows() + offset.y);
+
+	unsigned int size = 0;
+
+	for (int y = firstRow; y < endRow; y++) {
+
+		int row1 = y - _firstRow;
+		int row2 = y - offset.y - other._firstRow;
+
+		unsigned int begin1 = rowBegin(row1);
+		unsigned int begin2 = other.rowBegin(row2);
+		unsigned int n1     = rowEnd(row1) - begin1;
+		unsigned int n2     = other.rowEnd(row2) - begin2;
+
+		if (n1 == 0 || n2 == 0)
+			continue;
+
+		size += intersectRows(
+				&_begins[begin1], &_ends[begin1], n1,
+				&other._begins[begin2], &other._ends[begin2], n2,
+				offset.x);
+	}
+
+	return size;
+}
+
+RowSpans
+RowSpans::intersection(const RowSpans& other) const {
+
+	RowSpans result;
+
+	if (_size == 0 || other._size == 0)
+		return result;
+
+	int firstRow = std::max(_firstRow, other._firstRow);
+	int endRow   = std::min(_firstRow + numRows(), other._firstRow + other.numRows());
+
+	if (firstRow >= endRow)
+		return result;
+
+	result._firstRow = firstRow;
+	result._rowOffsets.assign(endRow - firstRow + 1, 0);
+
+	for (int y = firstRow; y < endRow; y++) {
+
+		int row1 = y - _firstRow;
+		int row2 = y - other._firstRow;
+
+		unsigned int i = rowBegin(row1), end1 = rowEnd(row1);
+		unsigned int j = other.rowBegin(row2), end2 = other.rowEnd(row2);
+
+		while (i < end1 && j < end2) {
+
+			int begin = std::max(_begins[i], other._begins[j]);
+			int end   = std::min(_ends[i], other._ends[j]);
+
+			if (begin < end) {
+
+				result._begins.push_back(begin);
+				result._ends.push_back(end);
+			}
+
+			if (_ends[i] <= other._ends[j])
+				i++;
+			else
+				j++;
+		}
+
+		result._rowOffsets[y - firstRow + 1] = result._begins.size();
+	}
+
+	// remove empty rows at the ends
+	unsigned int first = 0;
+	while (result._rowOffsets[first + 1] == 0 && first + 1 < result._rowOffsets.size() - 1)
+		first++;
+	unsigned int last = result._rowOffsets.size() - 1;
+	while (last > first + 1 && result._rowOffsets[last - 1] == result._rowOffsets[last])
+		last--;
+
+	result._rowOffsets.erase(result._rowOffsets.begin() + last + 1, result._rowOffsets.end());
+	result._rowOffsets.erase(result._rowOffsets.begin(), result._rowOffsets.begin() + first);
+	result._firstRow += first;
+
+	result.finish();
+
+	if (result._size == 0)
+		return RowSpans();
+
+	return result;
+}
+
+boost::uint64_t
+RowSpans::hashValue() const {
+
+	boost::uint64_t hash = mix(_size);
+
+	for (int row = 0; row < numRows(); row++)
+		for (unsigned int i = rowBegin(row); i < rowEnd(row); i++) {
+
+			boost::uint64_t span =
+					(static_cast<boost::uint64_t>(static_cast<boost::uint32_t>(_firstRow + row)) << 32) ^
+					(static_cast<boost::uint64_t>(static_cast<boost::uint32_t>(_begins[i])) << 16) ^
+					static_cast<boost::uint32_t>(_ends[i]);
+
+			hash = mix(hash ^ span);
+		}
+
+	return hash;
+}
+
+bool
+RowSpans::operator==(const RowSpans& other) const {
+
+	if (_size != other._size || _begins.size() != other._begins.size())
+		return false;
+
+	if (_size == 0)
+		return true;
+
+	return
+			_firstRow == other._firstRow &&
+			_rowOffsets == other._rowOffsets &&
+			_begins == other._begins &&
+			_ends == other._ends;
+}
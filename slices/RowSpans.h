@@ -0,0 +1,140 @@
+#ifndef MULTI2CUT_SLICES_ROW_SPANS_H__
+#define MULTI2CUT_SLICES_ROW_SPANS_H__
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <util/point.hpp>
+#include <util/rect.hpp>
+
+/**
+ * A run-length encoding of a set of pixels: for each row, the sorted list of 
+ * maximal spans [begin, end) of consecutive pixels.
+ *
+ * The span bounds are stored in two separate arrays, and the spans of each row 
+ * are contiguous in them, such that the intersection of two rows is a linear 
+ * merge over plain integer arrays.
+ */
+class RowSpans {
+
+public:
+
+	/**
+	 * Create an empty set of spans.
+	 */
+	RowSpans();
+
+	/**
+	 * Create the spans of the given pixels, which can be in any order.
+	 */
+	template <typename PixelIterator>
+	RowSpans(PixelIterator begin, PixelIterator end);
+
+	/**
+	 * The number of pixels.
+	 */
+	unsigned int size() const { return _size; }
+
+	/**
+	 * The bounding box of the pixels, with exclusive upper bounds.
+	 */
+	const util::rect<int>& getBoundingBox() const { return _boundingBox; }
+
+	/**
+	 * The mean position of the pixels.
+	 */
+	const util::point<double>& getCenter() const { return _center; }
+
+	/**
+	 * Move all pixels by the given offset.
+	 */
+	void translate(const util::point<int>& offset);
+
+	/**
+	 * The number of pixels in the intersection of these spans and the given 
+	 * spans translated by offset.
+	 */
+	unsigned int intersectionSize(const RowSpans& other, const util::point<int>& offset = util::point<int>(0, 0)) const;
+
+	/**
+	 * The spans of the intersection with the given spans.
+	 */
+	RowSpans intersection(const RowSpans& other) const;
+
+	/**
+	 * The first row and the number of rows between the first and last row 
+	 * with pixels.
+	 */
+	int firstRow() const { return _firstRow; }
+	int numRows() const { return static_cast<int>(_rowOffsets.size()) - 1; }
+
+	/**
+	 * The indices [rowBegin(row), rowEnd(row)) of the spans of a row, relative 
+	 * to firstRow().
+	 */
+	unsigned int rowBegin(int row) const { return _rowOffsets[row]; }
+	unsigned int rowEnd(int row) const { return _rowOffsets[row + 1]; }
+
+	/**
+	 * The bounds of span i.
+	 */
+	int spanBegin(unsigned int i) const { return _begins[i]; }
+	int spanEnd(unsigned int i) const { return _ends[i]; }
+
+	/**
+	 * A hash value of the spans, equal for equal sets of pixels.
+	 */
+	boost::uint64_t hashValue() const;
+
+	/**
+	 * True if both spans contain the same pixels.
+	 */
+	bool operator==(const RowSpans& other) const;
+
+	/**
+	 * Set all pixels of the spans in the given 2D array to value.
+	 */
+	template <typename ArrayType, typename ValueType>
+	void rasterize(ArrayType& array, ValueType value) const;
+
+private:
+
+	void create(std::vector<util::point<int> >& pixels);
+
+	void finish();
+
+	int _firstRow;
+
+	// the offsets of the spans of each row, plus the total number of spans
+	std::vector<unsigned int> _rowOffsets;
+
+	std::vector<int> _begins;
+	std::vector<int> _ends;
+
+	unsigned int _size;
+
+	util::rect<int> _boundingBox;
+
+	util::point<double> _center;
+};
+
+template <typename PixelIterator>
+RowSpans::RowSpans(PixelIterator begin, PixelIterator end) {
+
+	std::vector<util::point<int> > pixels;
+	for (PixelIterator i = begin; i != end; i++)
+		pixels.push_back(util::point<int>(i->x, i->y));
+
+	create(pixels);
+}
+
+template <typename ArrayType, typename ValueType>
+void
+RowSpans::rasterize(ArrayType& array, ValueType value) const {
+
+	for (int row = 0; row < numRows(); row++)
+		for (unsigned int i = rowBegin(row); i < rowEnd(row); i++)
+			for (int x = _begins[i]; x < _ends[i]; x++)
+				array(x, _firstRow + row) = value;
+}
+
+#endif // MULTI2CUT_SLICES_ROW_SPANS_H__
@@ -4,15 +4,28 @@
 #include <iostream>
 #include "Slice.h"
 
+util::ProgramOption optionRunLengthSlices(
+		util::_long_name        = "runLengthSlices",
+		util::_description_text = "Store the pixels of each slice as a run-length encoding instead of a connected component, "
+		                          "which is used to compute overlaps and to rasterize slices. This saves memory only for "
+		                          "slices that own their components, like those extracted from merge histories: component "
+		                          "trees stay alive as pipeline outputs, and the encoding is kept in addition to them.");
+
 Slice::Slice(
 		unsigned int id,
 		unsigned int section,
 		boost::shared_ptr<ConnectedComponent> component) :
 	_id(id),
 	_section(section),
-	_component(component),
 	_level(0),
-	_numDescendants(0) {}
+	_numDescendants(0),
+	_value(component->getValue()) {
+
+	if (optionRunLengthSlices)
+		_spans = boost::make_shared<RowSpans>(component->getPixels().first, component->getPixels().second);
+	else
+		_component = component;
+}
 
 unsigned int
 Slice::getId() const {
@@ -29,24 +42,111 @@ Slice::getSection() const {
 boost::shared_ptr<ConnectedComponent>
 Slice::getComponent() const {
 
-	return _component;
+	if (_component)
+		return _component;
+
+	// refer to the shared pixel list, without copying the pixels
+	if (_pixelRange.valid()) {
+
+		boost::shared_ptr<PixelList> pixelList = boost::const_pointer_cast<PixelList>(_pixelRange.getPixelList());
+
+		return boost::make_shared<ConnectedComponent>(
+				boost::shared_ptr<Image>(),
+				_value,
+				pixelList,
+				pixelList->begin() + _pixelRange.offset(),
+				pixelList->begin() + _pixelRange.offset() + _pixelRange.size());
+	}
+
+	boost::shared_ptr<PixelList> pixelList = boost::make_shared<PixelList>(_spans->size());
+
+	for (int row = 0; row < _spans->numRows(); row++)
+		for (unsigned int i = _spans->rowBegin(row); i < _spans->rowEnd(row); i++)
+			for (int x = _spans->spanBegin(i); x < _spans->spanEnd(i); x++)
+				pixelList->add(util::point<unsigned int>(x, _spans->firstRow() + row));
+
+	return boost::make_shared<ConnectedComponent>(
+			boost::shared_ptr<Image>(),
+			_value,
+			pixelList,
+			pixelList->begin(),
+			pixelList->end());
+}
+
+unsigned int
+Slice::getSize() const {
+
+	if (_spans)
+		return _spans->size();
+
+	return _component->getSize();
+}
+
+util::point<double>
+Slice::getCenter() const {
+
+	if (_spans)
+		return _spans->getCenter();
+
+	return _component->getCenter();
+}
+
+util::rect<unsigned int>
+Slice::getBoundingBox() const {
+
+	if (_spans) {
+
+		const util::rect<int>& bb = _spans->getBoundingBox();
+
+		return util::rect<unsigned int>(bb.minX, bb.minY, bb.maxX, bb.maxY);
+	}
+
+	return _component->getBoundingBox();
 }
 
 void
 Slice::intersect(const Slice& other) {
 
-	_component = boost::make_shared<ConnectedComponent>(getComponent()->intersect(*other.getComponent()));
+	if (_spans) {
+
+		if (other._spans)
+			_spans = boost::make_shared<RowSpans>(_spans->intersection(*other._spans));
+		else
+			_spans = boost::make_shared<RowSpans>(_spans->intersection(
+					RowSpans(other._component->getPixels().first, other._component->getPixels().second)));
+
+	} else {
+
+		_component = boost::make_shared<ConnectedComponent>(_component->intersect(*other.getComponent()));
+	}
+
+	_pixelRange = PixelRange();
 }
 
 void
 Slice::translate(const util::point<int>& pt)
 {
-	_component = boost::make_shared<ConnectedComponent>(getComponent()->translate(pt));
+	if (_spans) {
+
+		_spans = boost::make_shared<RowSpans>(*_spans);
+		_spans->translate(pt);
+
+	} else {
+
+		_component = boost::make_shared<ConnectedComponent>(_component->translate(pt));
+	}
+
+	_pixelRange = PixelRange();
 }
 
 bool
 Slice::operator==(const Slice& other) const
 {
-	return getSection() == other.getSection() && (*getComponent()) == (*other.getComponent());
-}
+	if (getSection() != other.getSection())
+		return false;
 
+	if (_spans && other._spans)
+		return (*_spans) == (*other._spans);
+
+	return (*getComponent()) == (*other.getComponent());
+}
@@ -3,11 +3,14 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <imageprocessing/ConnectedComponent.h>
 #include <util/ProgramOptions.h>
+#include <util/foreach.h>
 #include <util/rect.hpp>
+#include "PixelRange.h"
+#include "RowSpans.h"
 
-// forward declaration
-class ConnectedComponent;
+extern util::ProgramOption optionRunLengthSlices;
 
 class Slice {
 
@@ -30,16 +33,68 @@ public:
 	 */
 	unsigned int getId() const;
 
+	/**
+	 * Change the id of this slice. Only to be used before the slice is 
+	 * referred to by anything else than its own conflict sets.
+	 */
+	void setId(unsigned int id) { _id = id; }
+
 	/**
 	 * Get the section number, this slice lives in.
 	 */
 	unsigned int getSection() const;
 
 	/**
-	 * Get the blob of this slice.
+	 * Get the blob of this slice. Slices that keep a run-length encoding of 
+	 * their pixels do not store a blob, and create a new one on each call. The 
+	 * new blob refers to the pixel list of the slice's pixel range, if valid, 
+	 * and to a copy of the pixels otherwise. Prefer the accessors below, if 
+	 * they suffice.
 	 */
 	boost::shared_ptr<ConnectedComponent> getComponent() const;
 
+	/**
+	 * The number of pixels of this slice.
+	 */
+	unsigned int getSize() const;
+
+	/**
+	 * The mean position of the pixels of this slice.
+	 */
+	util::point<double> getCenter() const;
+
+	/**
+	 * The bounding box of this slice, with exclusive upper bounds.
+	 */
+	util::rect<unsigned int> getBoundingBox() const;
+
+	/**
+	 * Call visitor(const util::point<unsigned int>&) for each pixel of this 
+	 * slice.
+	 */
+	template <typename Visitor>
+	void forEachPixel(Visitor& visitor) const;
+
+	/**
+	 * True if this slice keeps a run-length encoding of its pixels instead of 
+	 * a blob, which is the case if optionRunLengthSlices is set.
+	 */
+	bool hasSpans() const { return _spans.get() != 0; }
+
+	/**
+	 * Get the run-length encoding of the pixels of this slice. Only valid if 
+	 * hasSpans() is true.
+	 */
+	const RowSpans& getSpans() const { return *_spans; }
+
+	/**
+	 * Get and set the range of this slice's pixels in a pixel list shared by 
+	 * all slices of a tree. Slices that are not part of a nested tree, or that 
+	 * have been intersected or translated, have no valid pixel range.
+	 */
+	void setPixelRange(const PixelRange& pixelRange) { _pixelRange = pixelRange; }
+	const PixelRange& getPixelRange() const { return _pixelRange; }
+
 	/**
 	 * Intersect this slice with another one. Note that the result might not be
 	 * a single connected component any longer.
@@ -78,8 +133,36 @@ private:
 
 	unsigned int _numDescendants;
 
+	// either the blob or the run-length encoding is set
 	boost::shared_ptr<ConnectedComponent> _component;
+
+	boost::shared_ptr<RowSpans> _spans;
+
+	// the value of the blob, to recreate it from the spans
+	double _value;
+
+	PixelRange _pixelRange;
 };
 
+template <typename Visitor>
+void
+Slice::forEachPixel(Visitor& visitor) const {
+
+	if (_spans) {
+
+		const RowSpans& spans = *_spans;
+
+		for (int row = 0; row < spans.numRows(); row++)
+			for (unsigned int i = spans.rowBegin(row); i < spans.rowEnd(row); i++)
+				for (int x = spans.spanBegin(i); x < spans.spanEnd(i); x++)
+					visitor(util::point<unsigned int>(x, spans.firstRow() + row));
+
+		return;
+	}
+
+	foreach (const util::point<unsigned int>& p, _component->getPixels())
+		visitor(p);
+}
+
 #endif // CELLTRACKER_CELL_H__
 
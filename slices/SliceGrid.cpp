@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <imageprocessing/ConnectedComponent.h>
+#include "SliceGrid.h"
+
+SliceGrid::SliceGrid(const Slices& slices) :
+	_slices(slices.begin(), slices.end()),
+	_minX(0),
+	_minY(0),
+	_width(0),
+	_height(0),
+	_cellSize(1),
+	_cellOffsets(1, 0) {
+
+	if (_slices.empty())
+		return;
+
+	_boundingBoxes.reserve(_slices.size());
+
+	double meanExtent = 0;
+	int    maxX = 0, maxY = 0;
+
+	_minX = boundingBox(*_slices[0]).minX;
+	_minY = boundingBox(*_slices[0]).minY;
+
+	for (unsigned int i = 0; i < _slices.size(); i++) {
+
+		util::rect<int> bb = boundingBox(*_slices[i]);
+
+		_boundingBoxes.push_back(bb);
+
+		_minX = std::min(_minX, bb.minX);
+		_minY = std::min(_minY, bb.minY);
+		maxX  = std::max(maxX, bb.maxX);
+		maxY  = std::max(maxY, bb.maxY);
+
+		meanExtent += 0.5*((bb.maxX - bb.minX) + (bb.maxY - bb.minY));
+	}
+
+	meanExtent /= _slices.size();
+
+	_cellSize = std::max(1, static_cast<int>(meanExtent));
+	_width    = (maxX - _minX + _cellSize - 1)/_cellSize + 1;
+	_height   = (maxY - _minY + _cellSize - 1)/_cellSize + 1;
+
+	// count the slices per cell, then fill the cells
+
+	_cellOffsets.assign(_width*_height + 1, 0);
+
+	for (int pass = 0; pass < 2; pass++) {
+
+		std::vector<unsigned int> next;
+
+		if (pass == 1) {
+
+			for (unsigned int c = 1; c < _cellOffsets.size(); c++)
+				_cellOffsets[c] += _cellOffsets[c - 1];
+
+			_cellSlices.resize(_cellOffsets.back());
+			next.assign(_cellOffsets.begin(), _cellOffsets.end() - 1);
+		}
+
+		for (unsigned int i = 0; i < _slices.size(); i++) {
+
+			const util::rect<int>& bb = _boundingBoxes[i];
+
+			int beginX = (bb.minX - _minX)/_cellSize;
+			int beginY = (bb.minY - _minY)/_cellSize;
+			int endX   = (std::max(bb.maxX - 1, bb.minX) - _minX)/_cellSize + 1;
+			int endY   = (std::max(bb.maxY - 1, bb.minY) - _minY)/_cellSize + 1;
+
+			for (int y = beginY; y < endY; y++)
+				for (int x = beginX; x < endX; x++) {
+
+					if (pass == 0)
+						_cellOffsets[y*_width + x + 1]++;
+					else
+						_cellSlices[next[y*_width + x]++] = i;
+				}
+		}
+	}
+}
+
+void
+SliceGrid::find(const util::rect<int>& query, std::vector<unsigned int>& indices) const {
+
+	indices.clear();
+
+	if (_slices.empty())
+		return;
+
+	if (query.maxX <= _minX || query.maxY <= _minY)
+		return;
+
+	int beginX = std::max(0, (query.minX - _minX)/_cellSize);
+	int beginY = std::max(0, (query.minY - _minY)/_cellSize);
+	int endX   = std::min(_width,  (std::max(query.maxX - 1, query.minX) - _minX)/_cellSize + 1);
+	int endY   = std::min(_height, (std::max(query.maxY - 1, query.minY) - _minY)/_cellSize + 1);
+
+	for (int y = beginY; y < endY; y++)
+		for (int x = beginX; x < endX; x++) {
+
+			int cell = y*_width + x;
+
+			for (unsigned int k = _cellOffsets[cell]; k < _cellOffsets[cell + 1]; k++) {
+
+				unsigned int           i  = _cellSlices[k];
+				const util::rect<int>& bb = _boundingBoxes[i];
+
+				if (bb.minX >= query.maxX || query.minX >= bb.maxX ||
+				    bb.minY >= query.maxY || query.minY >= bb.maxY)
+					continue;
+
+				// report each slice only in the cell that contains the lower 
+				// corner of the intersection
+				int cornerX = (std::max(bb.minX, query.minX) - _minX)/_cellSize;
+				int cornerY = (std::max(bb.minY, query.minY) - _minY)/_cellSize;
+
+				if (cornerX == x && cornerY == y)
+					indices.push_back(i);
+			}
+		}
+}
+
+util::rect<int>
+SliceGrid::boundingBox(const Slice& slice) {
+
+	const util::rect<unsigned int>& bb = slice.getBoundingBox();
+
+	return util::rect<int>(bb.minX, bb.minY, bb.maxX, bb.maxY);
+}
@@ -0,0 +1,57 @@
+#ifndef MULTI2CUT_SLICES_SLICE_GRID_H__
+#define MULTI2CUT_SLICES_SLICE_GRID_H__
+
+#include <vector>
+#include <util/rect.hpp>
+#include "Slices.h"
+
+/**
+ * A uniform grid over the bounding boxes of a set of slices, to find all 
+ * slices whose bounding box intersects a query box without comparing against 
+ * all slices.
+ *
+ * Each slice is registered in every cell its bounding box touches. The cell 
+ * size is the mean bounding box extent of the slices.
+ */
+class SliceGrid {
+
+public:
+
+	SliceGrid(const Slices& slices);
+
+	/**
+	 * The number of slices in this grid.
+	 */
+	unsigned int size() const { return _slices.size(); }
+
+	/**
+	 * Get the slice at the given index, in the order of the slices this grid 
+	 * was created from.
+	 */
+	boost::shared_ptr<Slice> getSlice(unsigned int index) const { return _slices[index]; }
+
+	/**
+	 * Get the indices of all slices with a bounding box that intersects the 
+	 * given box. Every such slice is reported exactly once.
+	 */
+	void find(const util::rect<int>& boundingBox, std::vector<unsigned int>& indices) const;
+
+private:
+
+	static util::rect<int> boundingBox(const Slice& slice);
+
+	std::vector<boost::shared_ptr<Slice> > _slices;
+	std::vector<util::rect<int> >          _boundingBoxes;
+
+	// the grid origin and size in cells
+	int _minX, _minY;
+	int _width, _height;
+	int _cellSize;
+
+	// the slice indices of each cell, cell c's indices start at 
+	// _cellOffsets[c] and end at _cellOffsets[c+1]
+	std::vector<unsigned int> _cellOffsets;
+	std::vector<unsigned int> _cellSlices;
+};
+
+#endif // MULTI2CUT_SLICES_SLICE_GRID_H__
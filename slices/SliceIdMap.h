@@ -0,0 +1,209 @@
+#ifndef MULTI2CUT_SLICES_SLICE_ID_MAP_H__
+#define MULTI2CUT_SLICES_SLICE_ID_MAP_H__
+
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <util/exceptions.h>
+
+/**
+ * A map from slice ids to values of type T, stored in a plain vector indexed
+ * by the slice id relative to the smallest id seen so far.
+ *
+ * Slice ids are reserved in consecutive ranges (see SliceIds), such that the
+ * ids of the slices of a problem cover a compact interval. Lookups are
+ * therefore a single vector access, and the values of consecutive ids are
+ * stored next to each other.
+ */
+template <typename T>
+class SliceIdMap {
+
+public:
+
+	/**
+	 * Iterates over the (id, value) pairs of all ids present in the map, in
+	 * increasing order of ids.
+	 */
+	class const_iterator : public std::iterator<
+			std::forward_iterator_tag,
+			std::pair<unsigned int, T>,
+			std::ptrdiff_t,
+			const std::pair<unsigned int, T>*,
+			std::pair<unsigned int, T> > {
+
+	public:
+
+		const_iterator(const SliceIdMap& map, unsigned int index) :
+			_map(&map),
+			_index(index) { skipAbsent(); }
+
+		/**
+		 * The id at the current position, without copying the value.
+		 */
+		unsigned int id() const { return _map->_firstId + _index; }
+
+		std::pair<unsigned int, T> operator*() const {
+
+			return std::make_pair(_map->_firstId + _index, _map->_values[_index]);
+		}
+
+		const_iterator& operator++() {
+
+			_index++;
+			skipAbsent();
+
+			return *this;
+		}
+
+		const_iterator operator++(int) {
+
+			const_iterator i = *this;
+			++(*this);
+
+			return i;
+		}
+
+		bool operator==(const const_iterator& other) const { return _index == other._index; }
+
+		bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+	private:
+
+		void skipAbsent() {
+
+			while (_index < _map->_present.size() && !_map->_present[_index])
+				_index++;
+		}
+
+		const SliceIdMap* _map;
+		unsigned int      _index;
+	};
+
+	typedef const_iterator iterator;
+
+	SliceIdMap() :
+		_firstId(0),
+		_size(0) {}
+
+	/**
+	 * Get the value for the given id. Creates a default value, if the id is
+	 * not present, yet.
+	 */
+	T& operator[](unsigned int id) {
+
+		unsigned int index = makeIndex(id);
+
+		if (!_present[index]) {
+
+			_present[index] = true;
+			_size++;
+		}
+
+		return _values[index];
+	}
+
+	/**
+	 * Get the value for the given id. Throws a UsageError, if the id is not
+	 * present.
+	 */
+	const T& operator[](unsigned int id) const { return at(id); }
+
+	/**
+	 * Get the value for the given id. Throws a UsageError, if the id is not
+	 * present.
+	 */
+	const T& at(unsigned int id) const {
+
+		if (!contains(id))
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"slice id " << id << " is not present in this map");
+
+		return _values[id - _firstId];
+	}
+
+	T& at(unsigned int id) {
+
+		return const_cast<T&>(static_cast<const SliceIdMap&>(*this).at(id));
+	}
+
+	/**
+	 * Check whether a value for the given id is present.
+	 */
+	bool contains(unsigned int id) const {
+
+		return id >= _firstId && id - _firstId < _present.size() && _present[id - _firstId];
+	}
+
+	/**
+	 * Remove the value for the given id, if present.
+	 */
+	void erase(unsigned int id) {
+
+		if (!contains(id))
+			return;
+
+		_present[id - _firstId] = false;
+		_values[id - _firstId]  = T();
+		_size--;
+	}
+
+	/**
+	 * The number of ids present in this map.
+	 */
+	unsigned int size() const { return _size; }
+
+	void clear() {
+
+		_values.clear();
+		_present.clear();
+		_firstId = 0;
+		_size    = 0;
+	}
+
+	const_iterator begin() const { return const_iterator(*this, 0); }
+
+	const_iterator end() const { return const_iterator(*this, _values.size()); }
+
+private:
+
+	/**
+	 * Get the vector index of the given id, growing the vectors if needed.
+	 */
+	unsigned int makeIndex(unsigned int id) {
+
+		if (_values.empty()) {
+
+			_firstId = id;
+
+		} else if (id < _firstId) {
+
+			unsigned int grow = _firstId - id;
+
+			_values.insert(_values.begin(), grow, T());
+			_present.insert(_present.begin(), grow, false);
+			_firstId = id;
+		}
+
+		unsigned int index = id - _firstId;
+
+		if (index >= _values.size()) {
+
+			_values.resize(index + 1);
+			_present.resize(index + 1, false);
+		}
+
+		return index;
+	}
+
+	// the id of the first element in _values
+	unsigned int _firstId;
+
+	std::vector<T>    _values;
+	std::vector<char> _present;
+
+	// the number of present ids
+	unsigned int _size;
+};
+
+#endif // MULTI2CUT_SLICES_SLICE_ID_MAP_H__
@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <vector>
+#include <util/foreach.h>
+#include "SliceIds.h"
+
+boost::atomic<unsigned int> SliceIds::NextId(0);
+
+unsigned int
+SliceIds::reserve(unsigned int n) {
+
+	return NextId.fetch_add(n, boost::memory_order_relaxed);
+}
+
+void
+SliceIds::renumber(Slices& slices, ConflictSets& conflictSets) {
+
+	std::vector<unsigned int> ids;
+	foreach (boost::shared_ptr<Slice> slice, slices)
+		ids.push_back(slice->getId());
+	std::sort(ids.begin(), ids.end());
+
+	unsigned int first = reserve(ids.size());
+
+	// the new id of a slice is first plus the rank of its old id
+	SliceIdMap<unsigned int> newIds;
+	foreach (boost::shared_ptr<Slice> slice, slices) {
+
+		newIds[slice->getId()] = first + (std::lower_bound(ids.begin(), ids.end(), slice->getId()) - ids.begin());
+		slice->setId(newIds[slice->getId()]);
+	}
+	slices.updateIds();
+
+	ConflictSets renumbered;
+	renumbered.merge(conflictSets, newIds);
+	conflictSets = renumbered;
+}
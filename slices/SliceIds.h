@@ -0,0 +1,37 @@
+#ifndef MULTI2CUT_SLICES_SLICE_IDS_H__
+#define MULTI2CUT_SLICES_SLICE_IDS_H__
+
+#include <boost/atomic.hpp>
+#include "ConflictSets.h"
+#include "Slices.h"
+
+/**
+ * Allocation of slice ids, unique among all slices of all sections.
+ *
+ * Extractors reserve the ids for all their slices at once, such that the ids 
+ * of one extractor are consecutive. If several extractors run concurrently, 
+ * the order of their ranges depends on the timing; renumber() can be used 
+ * afterwards to assign ranges in a fixed order.
+ */
+class SliceIds {
+
+public:
+
+	/**
+	 * Reserve n consecutive ids and return the first one.
+	 */
+	static unsigned int reserve(unsigned int n);
+
+	/**
+	 * Assign new ids to the given slices from a freshly reserved range, 
+	 * preserving the order of the previous ids, and update the conflict sets 
+	 * accordingly.
+	 */
+	static void renumber(Slices& slices, ConflictSets& conflictSets);
+
+private:
+
+	static boost::atomic<unsigned int> NextId;
+};
+
+#endif // MULTI2CUT_SLICES_SLICE_IDS_H__
@@ -1,132 +1,203 @@
+#include <algorithm>
+#include <limits>
+#include <boost/make_shared.hpp>
+#include <parallel/ParallelFor.h>
 #include "Slices.h"
 
 Slices::Slices() :
-	_adaptor(0),
-	_kdTree(0),
-	_kdTreeDirty(true) {}
+	_kdTreeDirty(false) {}
 
 Slices::Slices(const Slices& other) :
 	pipeline::Data(),
 	_slices(other._slices),
-	_adaptor(0),
-	_kdTree(0),
-	_kdTreeDirty(true) {}
+	_indices(other._indices),
+	_kdTreeDirty(false) {}
 
 Slices&
 Slices::operator=(const Slices& other) {
 
-	if (_kdTree)
-		delete _kdTree;
+	_kdTrees.clear();
+	_kdTreeDirty = false;
 
-	if (_adaptor)
-		delete _adaptor;
-
-	_kdTree = 0;
-	_adaptor = 0;
-	_kdTreeDirty = true;
-
-	_slices = other._slices;
+	_slices  = other._slices;
+	_indices = other._indices;
 
 	return *this;
 }
 
-Slices::~Slices() {
-
-	if (_kdTree)
-		delete _kdTree;
-
-	if (_adaptor)
-		delete _adaptor;
-}
-
 void
 Slices::clear() {
 
 	_slices.clear();
+	_indices.clear();
+
+	_kdTrees.clear();
+	_kdTreeDirty = false;
 }
 
 void
 Slices::add(boost::shared_ptr<Slice> slice) {
 
+	_indices[slice->getId()] = _slices.size();
 	_slices.push_back(slice);
-
-	_kdTreeDirty = true;
 }
 
 void
 Slices::addAll(const Slices& slices) {
 
-	_slices.insert(_slices.end(), slices.begin(), slices.end());
+	_slices.reserve(_slices.size() + slices.size());
 
-	_kdTreeDirty = true;
+	foreach (boost::shared_ptr<Slice> slice, slices) {
+
+		_indices[slice->getId()] = _slices.size();
+		_slices.push_back(slice);
+	}
 }
 
 void
 Slices::remove(boost::shared_ptr<Slice> slice) {
 
-	for (unsigned int i = 0; i < _slices.size(); i++)
-		if (_slices[i] == slice) {
+	if (!_indices.contains(slice->getId()) || _slices[_indices.at(slice->getId())] != slice)
+		return;
 
-			_slices.erase(_slices.begin() + i);
-			return;
-		}
+	unsigned int index = _indices.at(slice->getId());
+	_indices.erase(slice->getId());
+
+	// move the last slice into the gap
+	if (index != _slices.size() - 1) {
+
+		_slices[index] = _slices.back();
+		_indices[_slices[index]->getId()] = index;
+	}
+
+	_slices.pop_back();
 
-	return;
+	// the slices of the trees changed their order
+	_kdTreeDirty = true;
+}
+
+void
+Slices::updateIds() {
+
+	_indices.clear();
+
+	for (unsigned int i = 0; i < _slices.size(); i++)
+		_indices[_slices[i]->getId()] = i;
 }
 
 std::vector<boost::shared_ptr<Slice> >
 Slices::find(const util::point<double>& center, double distance) {
 
-	if (_kdTreeDirty) {
+	updateKdTrees();
+
+	return query(center, distance);
+}
 
-		delete _adaptor;
-		delete _kdTree;
+std::vector<std::vector<boost::shared_ptr<Slice> > >
+Slices::findAll(const std::vector<util::point<double> >& centers, double distance) {
 
-		_adaptor = 0;
-		_kdTree = 0;
-	}
+	updateKdTrees();
+
+	std::vector<std::vector<boost::shared_ptr<Slice> > > found(centers.size());
+
+	parallel::parallelFor(0, centers.size(), FindQuery(*this, centers, distance, found), 64);
+
+	return found;
+}
+
+void
+Slices::translate(const util::point<int>& offset) {
 
-	// create kd-tree, if it does not exist
-	if (!_kdTree) {
+	foreach (boost::shared_ptr<Slice> slice, _slices)
+		slice->translate(offset);
+
+	// the trees stay valid, if they know about the offset
+	foreach (KdTreeBlock& block, _kdTrees)
+		block.adaptor->translate(offset);
+}
 
-		// create slice vector adaptor
-		_adaptor = new SliceVectorAdaptor(_slices);
+void
+Slices::updateKdTrees() {
 
-		// create the tree
-		_kdTree = new SliceKdTree(2, *_adaptor, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+	if (_kdTreeDirty) {
 
-		// create index
-		_kdTree->buildIndex();
+		_kdTrees.clear();
+		_kdTreeDirty = false;
 	}
 
-	// find close indices
-	std::vector<std::pair<size_t, double> > results;
+	unsigned int numSlices = _slices.size();
+	unsigned int begin     = 0;
+	unsigned int block     = 0;
+
+	for (int bit = std::numeric_limits<unsigned int>::digits - 1; bit >= 0; bit--) {
+
+		unsigned int size = 1u << bit;
+
+		if (!(numSlices & size))
+			continue;
 
-	double query[2];
-	query[0] = center.x;
-	query[1] = center.y;
+		// keep the existing tree, if it covers the same range
+		if (block < _kdTrees.size() &&
+		    _kdTrees[block].adaptor->getBegin() == begin &&
+		    _kdTrees[block].adaptor->kdtree_get_point_count() == size) {
+
+			block++;
+			begin += size;
+			continue;
+		}
+
+		// this and all following trees have to be rebuilt
+		_kdTrees.resize(block);
+
+		KdTreeBlock newBlock;
+		newBlock.adaptor = boost::make_shared<SliceVectorAdaptor>(_slices, begin, size);
+		newBlock.kdTree  = boost::make_shared<SliceKdTree>(2, *newBlock.adaptor, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+		newBlock.kdTree->buildIndex();
+
+		_kdTrees.push_back(newBlock);
+
+		block++;
+		begin += size;
+	}
+}
+
+std::vector<boost::shared_ptr<Slice> >
+Slices::query(const util::point<double>& center, double distance) const {
 
 	nanoflann::SearchParams params(0 /* ignored parameter */);
 
-	_kdTree->radiusSearch(&query[0], distance, results, params);
+	// the indices of close slices with their distances, over all trees
+	std::vector<std::pair<double, unsigned int> > close;
+
+	foreach (const KdTreeBlock& block, _kdTrees) {
+
+		// query in the coordinates the tree was built with
+		double query[2];
+		query[0] = center.x - block.adaptor->getOffset().x;
+		query[1] = center.y - block.adaptor->getOffset().y;
+
+		std::vector<std::pair<size_t, double> > results;
+
+		block.kdTree->radiusSearch(&query[0], distance, results, params);
+
+		size_t index;
+		double dist;
+
+		foreach (boost::tie(index, dist), results)
+			close.push_back(std::make_pair(dist, block.adaptor->getBegin() + index));
+	}
+
+	// sort by distance, as a single tree would
+	std::sort(close.begin(), close.end());
 
 	// fill result vector
-	size_t index;
-	double dist;
+	double       dist;
+	unsigned int index;
 
 	std::vector<boost::shared_ptr<Slice> > found;
 
-	foreach (boost::tie(index, dist), results)
+	foreach (boost::tie(dist, index), close)
 		found.push_back(_slices[index]);
 
 	return found;
 }
-
-void
-Slices::translate(const util::point<int>& offset) {
-
-	foreach (boost::shared_ptr<Slice> slice, _slices)
-		slice->translate(offset);
-
-	_kdTreeDirty = true;
-}
@@ -8,10 +8,15 @@
 #include <imageprocessing/ConnectedComponent.h>
 #include <pipeline/all.h>
 #include "Slice.h"
+#include "SliceIdMap.h"
 
 /**
- * An adaptor class to use std::vector<boost::shared_ptr<Slice> > in a
- * nanoflann kd-tree.
+ * An adaptor class to use a range of a std::vector<boost::shared_ptr<Slice> >
+ * in a nanoflann kd-tree.
+ *
+ * The slice centers are reported relative to an offset, which is the 
+ * translation the slices underwent since the kd-tree was built. This way, the 
+ * kd-tree stays valid if all slices are moved by the same amount.
  */
 class SliceVectorAdaptor {
 
@@ -20,23 +25,45 @@ class SliceVectorAdaptor {
 public:
 
 	/**
-	 * Create a new adaptor.
+	 * Create a new adaptor for the size slices starting at begin.
 	 */
-	SliceVectorAdaptor(const slices_type& slices) :
-		_slices(slices) {}
+	SliceVectorAdaptor(const slices_type& slices, unsigned int begin, unsigned int size) :
+		_slices(slices),
+		_begin(begin),
+		_size(size),
+		_offset(0, 0) {}
+
+	/**
+	 * The index of the first slice of this adaptor in the slice vector.
+	 */
+	unsigned int getBegin() const { return _begin; }
+
+	/**
+	 * The translation of the slices since the kd-tree was built.
+	 */
+	const util::point<double>& getOffset() const { return _offset; }
+
+	/**
+	 * Record a translation of all slices.
+	 */
+	void translate(const util::point<int>& offset) {
+
+		_offset.x += offset.x;
+		_offset.y += offset.y;
+	}
 
 	/**
 	 * Nanoflann access interface. Gets the number of data points.
 	 */
-	size_t kdtree_get_point_count() const { return _slices.size(); }
+	size_t kdtree_get_point_count() const { return _size; }
 
 	/**
 	 * Nanoflann access interface. Gets the distance between two data points.
 	 */
 	inline double kdtree_distance(const double *p1, const size_t index_p2, size_t) const {
 
-		double d0 = p1[0] - _slices[index_p2]->getComponent()->getCenter().x;
-		double d1 = p1[1] - _slices[index_p2]->getComponent()->getCenter().y;
+		double d0 = p1[0] - kdtree_get_pt(index_p2, 0);
+		double d1 = p1[1] - kdtree_get_pt(index_p2, 1);
 
 		return d0*d0 + d1*d1;
 	}
@@ -48,9 +75,9 @@ public:
 	inline double kdtree_get_pt(const size_t index, int dim) const {
 
 		if (dim == 0)
-			return _slices[index]->getComponent()->getCenter().x;
+			return _slices[_begin + index]->getCenter().x - _offset.x;
 		else if (dim == 1)
-			return _slices[index]->getComponent()->getCenter().y;
+			return _slices[_begin + index]->getCenter().y - _offset.y;
 		else return 0;
 	}
 
@@ -65,10 +92,19 @@ private:
 
 	// a reference to the data to sort into the kd-tree
 	const slices_type& _slices;
+
+	// the range of slices to use
+	unsigned int _begin;
+	unsigned int _size;
+
+	// the translation since the kd-tree was built
+	util::point<double> _offset;
 };
 
 /**
- * A collection of slices.
+ * A collection of slices. Each slice has a dense index in [0, size()), which 
+ * is its position in the collection. Slices can be looked up and removed by 
+ * their id in constant time.
  */
 class Slices : public pipeline::Data {
 
@@ -97,8 +133,6 @@ public:
 	 */
 	Slices(const Slices& other);
 
-	~Slices();
-
 	/**
 	 * Assignment operator.
 	 */
@@ -120,10 +154,32 @@ public:
 	void addAll(const Slices& slices);
 
 	/**
-	 * Remove the given slice.
+	 * Remove the given slice. The last slice takes the index of the removed 
+	 * one.
 	 */
 	void remove(boost::shared_ptr<Slice> slice);
 
+	/**
+	 * Check whether a slice with the given id is part of this collection.
+	 */
+	bool contains(unsigned int sliceId) const { return _indices.contains(sliceId); }
+
+	/**
+	 * Get the index of the slice with the given id.
+	 */
+	unsigned int getIndex(unsigned int sliceId) const { return _indices.at(sliceId); }
+
+	/**
+	 * Get the slice with the given id.
+	 */
+	boost::shared_ptr<Slice> getById(unsigned int sliceId) const { return _slices[_indices.at(sliceId)]; }
+
+	/**
+	 * Update the id lookup after the ids of the contained slices have been 
+	 * changed.
+	 */
+	void updateIds();
+
 	const const_iterator begin() const { return _slices.begin(); }
 
 	iterator begin() { return _slices.begin(); }
@@ -136,11 +192,19 @@ public:
 
 	boost::shared_ptr<Slice> operator[](unsigned int i) { return _slices[i]; }
 
+	boost::shared_ptr<Slice> operator[](unsigned int i) const { return _slices[i]; }
+
 	/**
 	 * Find all slices within distance to the given center.
 	 */
 	std::vector<boost::shared_ptr<Slice> > find(const util::point<double>& center, double distance);
 
+	/**
+	 * Find all slices within distance to each of the given centers. The 
+	 * queries are answered in parallel.
+	 */
+	std::vector<std::vector<boost::shared_ptr<Slice> > > findAll(const std::vector<util::point<double> >& centers, double distance);
+
 	/**
 	 * Move all slices in 2D.
 	 */
@@ -148,16 +212,68 @@ public:
 
 private:
 
+	/**
+	 * Answers a batch of find queries, one per index.
+	 */
+	class FindQuery {
+
+	public:
+
+		FindQuery(
+				const Slices&                                         slices,
+				const std::vector<util::point<double> >&              centers,
+				double                                                distance,
+				std::vector<std::vector<boost::shared_ptr<Slice> > >& found) :
+			_slices(slices),
+			_centers(centers),
+			_distance(distance),
+			_found(found) {}
+
+		void operator()(unsigned int i) const {
+
+			_found[i] = _slices.query(_centers[i], _distance);
+		}
+
+	private:
+
+		const Slices&                                         _slices;
+		const std::vector<util::point<double> >&              _centers;
+		double                                                _distance;
+		std::vector<std::vector<boost::shared_ptr<Slice> > >& _found;
+	};
+
+	/**
+	 * A static kd-tree over a range of the slices.
+	 */
+	struct KdTreeBlock {
+
+		boost::shared_ptr<SliceVectorAdaptor> adaptor;
+		boost::shared_ptr<SliceKdTree>        kdTree;
+	};
+
+	/**
+	 * Bring the kd-trees up to date with the current slices.
+	 */
+	void updateKdTrees();
+
+	/**
+	 * Query the kd-trees, assuming they are up to date.
+	 */
+	std::vector<boost::shared_ptr<Slice> > query(const util::point<double>& center, double distance) const;
+
 	// the slices
 	slices_type _slices;
 
-	// nanoflann vector adaptor
-	SliceVectorAdaptor* _adaptor;
+	// the index of each slice by its id
+	SliceIdMap<unsigned int> _indices;
 
-	// a kd-tree, which is created on-demand
-	SliceKdTree* _kdTree;
+	// kd-trees over consecutive ranges of slices, created on-demand, with 
+	// sizes following the binary representation of the number of slices 
+	// (largest first), such that appending slices rebuilds only the trees of 
+	// the last ranges
+	std::vector<KdTreeBlock> _kdTrees;
 
-	// indicate that the tree has to be (re)build
+	// indicate that all trees have to be rebuilt
 	bool _kdTreeDirty;
 };
 
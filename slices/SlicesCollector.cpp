@@ -1,10 +1,68 @@
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <boost/cstdint.hpp>
+#include <boost/make_shared.hpp>
+#include <vigra/multi_array.hxx>
+#include <imageprocessing/ConnectedComponent.h>
+#include <parallel/ParallelFor.h>
 #include <util/Logger.h>
+#include <util/ProgramOptions.h>
 #include "SlicesCollector.h"
 
+util::ProgramOption optionConflictCliques(
+		util::_long_name        = "conflictCliques",
+		util::_description_text = "Instead of one conflict set per leaf of each tree and one per pair of overlapping slices of "
+		                          "different trees, create one conflict set for each distinct set of slices that cover a pixel. "
+		                          "This allows the same solutions with far fewer constraints.");
+
 logger::LogChannel slicescollectorlog("slicescollectorlog", "[SlicesCollector] ");
 
-SlicesCollector::SlicesCollector() :
-	_overlap(false /* don't normalize */, false /* don't align */) {
+namespace {
+
+// Refines the pixel classes by the visited slice: all pixels of a class that 
+// are covered by the slice move to a new class. Classes form a tree, in which 
+// each class is its parent plus one slice.
+struct ClassRefiner {
+
+	ClassRefiner(
+			vigra::MultiArray<2, unsigned int>& classes,
+			std::vector<unsigned int>&          parents,
+			std::vector<unsigned int>&          sliceIds,
+			unsigned int                        sliceId) :
+		classes(classes),
+		parents(parents),
+		sliceIds(sliceIds),
+		sliceId(sliceId) {}
+
+	void operator()(const util::point<unsigned int>& p) {
+
+		unsigned int& c = classes(p.x, p.y);
+
+		std::map<unsigned int, unsigned int>::iterator i = refined.find(c);
+
+		if (i == refined.end()) {
+
+			i = refined.insert(std::make_pair(c, static_cast<unsigned int>(parents.size()))).first;
+			parents.push_back(c);
+			sliceIds.push_back(sliceId);
+		}
+
+		c = i->second;
+	}
+
+	vigra::MultiArray<2, unsigned int>& classes;
+	std::vector<unsigned int>&          parents;
+	std::vector<unsigned int>&          sliceIds;
+	unsigned int                        sliceId;
+
+	// the new class for each class seen so far
+	std::map<unsigned int, unsigned int> refined;
+};
+
+} // anonymous namespace
+
+SlicesCollector::SlicesCollector() {
 
 	registerInputs(_slices, "slices");
 	registerInputs(_conflictSets, "conflict sets");
@@ -23,83 +81,248 @@ SlicesCollector::updateOutputs() {
 	_allSlices->clear();
 	_allConflictSets->clear();
 
-	// slice hash to slice id for each unique slice
-	std::map<ConnectedComponentHash, unsigned int> sliceHashes;
+	std::vector<boost::shared_ptr<Slice> > slices;
+	foreach (boost::shared_ptr<Slices> inputSlices, _slices)
+		slices.insert(slices.end(), inputSlices->begin(), inputSlices->end());
 
-	// slice id to slice id of already added duplicate
-	std::map<unsigned int, unsigned int>           sliceCopies;
+	// a compact encoding of each slice and its hash, computed in parallel
 
-	// copy only unique slices
-	foreach (boost::shared_ptr<Slices> slices, _slices) {
+	std::vector<RowSpans>        ownEncodings(slices.size());
+	std::vector<const RowSpans*> encodings(slices.size());
+	std::vector<boost::uint64_t> hashes(slices.size());
 
-		foreach (boost::shared_ptr<Slice> slice, *slices) {
+	parallel::parallelFor(0, slices.size(), SliceHasher(slices, ownEncodings, encodings, hashes), 64);
 
-			ConnectedComponentHash hash = slice->getComponent()->hashValue();
+	// slice id to slice id of the first equal slice, the identity for unique 
+	// slices
 
-			// duplicate?
-			if (sliceHashes.count(hash)) {
+	unsigned int maxId = 0;
+	foreach (boost::shared_ptr<Slice> slice, slices)
+		maxId = std::max(maxId, slice->getId());
 
-				// remember mapping of this slice to duplicate
-				sliceCopies[slice->getId()] = sliceHashes[hash];
+	_sliceCopies.resize(maxId + 1);
+	for (unsigned int id = 0; id <= maxId; id++)
+		_sliceCopies[id] = id;
 
-			} else {
+	// an open-addressing hash table of the indices of unique slices, with 
+	// linear probing
 
-				// add the slice
-				_allSlices->add(slice);
+	unsigned int tableSize = 1;
+	while (tableSize < 2*slices.size())
+		tableSize *= 2;
 
-				// remember it via its hash
-				sliceHashes[hash] = slice->getId();
-			}
-		}
-	}
+	const unsigned int Empty = std::numeric_limits<unsigned int>::max();
+	std::vector<unsigned int> table(tableSize, Empty);
 
-	LOG_USER(slicescollectorlog) << "removed " << sliceCopies.size() << " duplicates" << std::endl;
-	LOG_USER(slicescollectorlog) << "adding new constraints..." << std::flush;
+	unsigned int numDuplicates = 0;
 
-	// copy conflict sets, map slice ids of duplicates
-	foreach (boost::shared_ptr<ConflictSets> conflictSets, _conflictSets) {
+	// copy only unique slices, in the order of the inputs
+	for (unsigned int i = 0; i < slices.size(); i++) {
+
+		unsigned int slot = hashes[i] & (tableSize - 1);
+
+		while (table[slot] != Empty) {
+
+			unsigned int j = table[slot];
+
+			// equal hash values are verified by comparing the encodings
+			if (hashes[j] == hashes[i] && *encodings[j] == *encodings[i])
+				break;
 
-		foreach (const ConflictSet& conflictSet, *conflictSets) {
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		// duplicate?
+		if (table[slot] != Empty) {
+
+			// remember mapping of this slice to duplicate
+			_sliceCopies[slices[i]->getId()] = slices[table[slot]]->getId();
+			numDuplicates++;
 
-			ConflictSet mapped;
-			foreach (unsigned int sliceId, conflictSet.getSlices()) {
+		} else {
 
-				// is a duplicate?
-				if (sliceCopies.count(sliceId))
-					mapped.addSlice(sliceCopies[sliceId]);
-				else
-					mapped.addSlice(sliceId);
-			}
+			// add the slice
+			_allSlices->add(slices[i]);
 
-			_allConflictSets->add(mapped);
+			table[slot] = i;
 		}
 	}
 
+	LOG_USER(slicescollectorlog) << "removed " << numDuplicates << " duplicates" << std::endl;
+
+	if (optionConflictCliques) {
+
+		addConflictCliques();
+		return;
+	}
+
+	LOG_USER(slicescollectorlog) << "adding new constraints..." << std::flush;
+
+	// copy conflict sets, map slice ids of duplicates
+	foreach (boost::shared_ptr<ConflictSets> conflictSets, _conflictSets)
+		_allConflictSets->merge(*conflictSets, _sliceCopies);
+
 	LOG_USER(slicescollectorlog) << "done." << std::endl;
 
 	// create new conflict sets
+	addConflicts();
+}
+
+void
+SlicesCollector::addConflicts() {
+
+	std::vector<boost::shared_ptr<SliceGrid> > grids;
+	foreach (boost::shared_ptr<Slices> slices, _slices) {
+
+		// bitmaps might be created lazily, make sure this does not happen 
+		// concurrently
+		foreach (boost::shared_ptr<Slice> slice, *slices)
+			if (!slice->hasSpans())
+				slice->getComponent()->getBitmap();
+
+		grids.push_back(boost::make_shared<SliceGrid>(*slices));
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int> > pairs;
 	for (unsigned int i = 0; i < _slices.size(); i++)
 		for (unsigned int j = i + 1; j < _slices.size(); j++)
-			addConflicts(*_slices[i], *_slices[j]);
+			pairs.push_back(std::make_pair(i, j));
+
+	std::vector<ConflictSets> conflicts(pairs.size());
+	parallel::parallelFor(0, pairs.size(), PairConflicts(pairs, grids, _sliceCopies, conflicts));
+
+	// add in the order of the pairs, independent of the number of threads
+	for (unsigned int i = 0; i < conflicts.size(); i++)
+		_allConflictSets->addAll(conflicts[i]);
+}
+
+void
+SlicesCollector::SliceHasher::operator()(unsigned int i) const {
+
+	const Slice& slice = *_slices[i];
+
+	if (slice.hasSpans()) {
+
+		_encodings[i] = &slice.getSpans();
+
+	} else {
+
+		_ownEncodings[i] = RowSpans(slice.getComponent()->getPixels().first, slice.getComponent()->getPixels().second);
+		_encodings[i]    = &_ownEncodings[i];
+	}
+
+	_hashes[i] = _encodings[i]->hashValue();
 }
 
 void
-SlicesCollector::addConflicts(
-		const Slices& slicesA,
-		const Slices& slicesB) {
+SlicesCollector::PairConflicts::operator()(unsigned int i) const {
+
+	const SliceGrid& gridA = *_grids[_pairs[i].first];
+	const SliceGrid& gridB = *_grids[_pairs[i].second];
+
+	Overlap overlap(false /* don't normalize */, false /* don't align */);
+
+	std::vector<unsigned int> candidates;
 
 	// find all overlapping slices and add pairwise conflicts
-	foreach (boost::shared_ptr<Slice> sliceA, slicesA)
-		foreach (boost::shared_ptr<Slice> sliceB, slicesB) {
+	for (unsigned int a = 0; a < gridA.size(); a++) {
+
+		boost::shared_ptr<Slice> sliceA = gridA.getSlice(a);
+
+		const util::rect<unsigned int>& bb = sliceA->getBoundingBox();
+		gridB.find(util::rect<int>(bb.minX, bb.minY, bb.maxX, bb.maxY), candidates);
+
+		// report in the order of the slices in B
+		std::sort(candidates.begin(), candidates.end());
+
+		foreach (unsigned int b, candidates) {
+
+			boost::shared_ptr<Slice> sliceB = gridB.getSlice(b);
 
 			// overlap?
-			if (!_overlap.exceeds(*sliceA, *sliceB, 0))
+			if (!overlap.exceeds(*sliceA, *sliceB, 0))
+				continue;
+
+			// the ids of the slices that were kept
+			unsigned int idA = _sliceCopies[sliceA->getId()];
+			unsigned int idB = _sliceCopies[sliceB->getId()];
+
+			if (idA == idB)
+				continue;
+
+			unsigned int conflictSet[2] = { idA, idB };
+
+			_conflicts[i].add(conflictSet, conflictSet + 2);
+		}
+	}
+}
+
+void
+SlicesCollector::addConflictCliques() {
+
+	unsigned int numTreeConflictSets = 0;
+	foreach (boost::shared_ptr<ConflictSets> conflictSets, _conflictSets)
+		numTreeConflictSets += conflictSets->size();
+
+	// the size of an image containing all slices
+
+	unsigned int width  = 0;
+	unsigned int height = 0;
+	foreach (boost::shared_ptr<Slice> slice, *_allSlices) {
+
+		const util::rect<unsigned int>& bb = slice->getBoundingBox();
+
+		width  = std::max(width, bb.maxX);
+		height = std::max(height, bb.maxY);
+	}
+
+	// Partition the pixels by the set of slices that cover them: starting 
+	// from one class of uncovered pixels, each slice splits every class it 
+	// touches. Since each slice is visited once, two pixels end up in the same 
+	// class exactly if they are covered by the same slices.
+
+	vigra::MultiArray<2, unsigned int> classes(vigra::Shape2(width, height), 0u);
+
+	// the parent class and the added slice of each class, class 0 is empty
+	std::vector<unsigned int> parents(1, 0);
+	std::vector<unsigned int> classSliceIds(1, 0);
+
+	foreach (boost::shared_ptr<Slice> slice, *_allSlices) {
+
+		ClassRefiner refiner(classes, parents, classSliceIds, slice->getId());
+		slice->forEachPixel(refiner);
+	}
+
+	// the slices of each class that covers a pixel, in the order in which the 
+	// classes are first seen
+
+	std::vector<ConflictSet> cliques;
+	std::vector<char>        seen(parents.size(), false);
+
+	for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++) {
+
+			unsigned int c = classes(x, y);
+
+			if (c == 0 || seen[c])
 				continue;
 
-			ConflictSet conflictSet;
-			conflictSet.addSlice(sliceA->getId());
-			conflictSet.addSlice(sliceB->getId());
+			seen[c] = true;
+
+			cliques.push_back(ConflictSet());
+			for (; c != 0; c = parents[c])
+				cliques.back().addSlice(classSliceIds[c]);
+		}
+
+	unsigned int numCliques = 0;
+	foreach (const ConflictSet& clique, cliques)
+		if (clique.getSlices().size() > 1) {
 
-			_allConflictSets->add(conflictSet);
+			_allConflictSets->add(clique);
+			numCliques++;
 		}
+
+	LOG_USER(slicescollectorlog)
+			<< "replaced " << numTreeConflictSets << " tree conflict sets and all pairwise conflicts by "
+			<< numCliques << " pixel cliques" << std::endl;
 }
@@ -1,14 +1,32 @@
 #ifndef MULTI2CUT_SLICES_SLICES_COLLECTOR_H__
 #define MULTI2CUT_SLICES_SLICES_COLLECTOR_H__
 
+#include <vector>
+#include <boost/cstdint.hpp>
 #include <pipeline/SimpleProcessNode.h>
 #include <features/Overlap.h>
 #include "Slices.h"
+#include "SliceGrid.h"
 #include "ConflictSets.h"
 
 /**
  * Collect slices from multiple Slices into a single Slices. A ConflictSet is 
  * created for each pair of overlapping slices.
+ *
+ * Equal slices are kept only once. They are found by hashing the run-length 
+ * encodings of all slices in parallel, followed by an open-addressing hash 
+ * table in which equal hashes are verified by comparing the encodings. The 
+ * conflict sets refer to the slices that were kept.
+ *
+ * Overlapping pairs are found by querying a grid over the bounding boxes of 
+ * the other Slices, and pairs of Slices are processed in parallel.
+ *
+ * If optionConflictCliques is set, the conflict sets of the inputs and the 
+ * pairwise conflicts are replaced by one conflict set for each distinct set of 
+ * slices that cover a common pixel. Every pair of overlapping slices, and 
+ * every leaf-to-root path of a tree, is contained in one of these sets, such 
+ * that the feasible solutions are the same. The sets are found exactly, by 
+ * refining a partition of the pixels with each slice.
  */
 class SlicesCollector : public pipeline::SimpleProcessNode<> {
 
@@ -20,16 +38,65 @@ private:
 
 	void updateOutputs();
 
-	void addConflicts(
-			const Slices& slicesA,
-			const Slices& slicesB);
+	class SliceHasher {
+
+	public:
+
+		SliceHasher(
+				const std::vector<boost::shared_ptr<Slice> >& slices,
+				std::vector<RowSpans>&                        ownEncodings,
+				std::vector<const RowSpans*>&                 encodings,
+				std::vector<boost::uint64_t>&                 hashes) :
+			_slices(slices),
+			_ownEncodings(ownEncodings),
+			_encodings(encodings),
+			_hashes(hashes) {}
+
+		void operator()(unsigned int i) const;
+
+	private:
+
+		const std::vector<boost::shared_ptr<Slice> >& _slices;
+		std::vector<RowSpans>&                        _ownEncodings;
+		std::vector<const RowSpans*>&                 _encodings;
+		std::vector<boost::uint64_t>&                 _hashes;
+	};
+
+	class PairConflicts {
+
+	public:
+
+		PairConflicts(
+				const std::vector<std::pair<unsigned int, unsigned int> >& pairs,
+				const std::vector<boost::shared_ptr<SliceGrid> >&          grids,
+				const std::vector<unsigned int>&                           sliceCopies,
+				std::vector<ConflictSets>&                                 conflicts) :
+			_pairs(pairs),
+			_grids(grids),
+			_sliceCopies(sliceCopies),
+			_conflicts(conflicts) {}
+
+		void operator()(unsigned int i) const;
+
+	private:
+
+		const std::vector<std::pair<unsigned int, unsigned int> >& _pairs;
+		const std::vector<boost::shared_ptr<SliceGrid> >&          _grids;
+		const std::vector<unsigned int>&                           _sliceCopies;
+		std::vector<ConflictSets>&                                 _conflicts;
+	};
+
+	void addConflicts();
+
+	void addConflictCliques();
 
 	pipeline::Inputs<Slices>       _slices;
 	pipeline::Inputs<ConflictSets> _conflictSets;
 	pipeline::Output<Slices>       _allSlices;
 	pipeline::Output<ConflictSets> _allConflictSets;
 
-	Overlap _overlap;
+	// for each slice id, the id of the first equal slice that was kept
+	std::vector<unsigned int> _sliceCopies;
 };
 
 #endif // MULTI2CUT_SLICES_SLICES_COLLECTOR_H__
@@ -1,58 +1,103 @@
+#include <algorithm>
 #include "SlicesTree.h"
 #include <util/Logger.h>
 
 logger::LogChannel slicestreelog("slicestreelog", "[SlicesTree] ");
 
-SlicesTree::Node::Node(boost::shared_ptr<Slice> slice) :
-	_slice(slice) {}
+const SlicesTree::NodeId SlicesTree::NoNode = std::numeric_limits<SlicesTree::NodeId>::max();
 
-void
-SlicesTree::Node::setParent(boost::shared_ptr<SlicesTree::Node> parent) {
+SlicesTree::PreOrderIterator&
+SlicesTree::PreOrderIterator::operator++() {
 
-	_parent = parent;
-}
+	// descend to the first child
+	NodeId child = _tree.getFirstChild(_current);
+	if (child != NoNode) {
 
-boost::shared_ptr<SlicesTree::Node>
-SlicesTree::Node::getParent() {
+		_current = child;
+		return *this;
+	}
 
-	boost::shared_ptr<SlicesTree::Node> parent = _parent.lock();
+	// otherwise, go to the next sibling of the closest ancestor that has one
+	while (_current != _root) {
 
-	return parent;
-}
+		NodeId sibling = _tree.getNextSibling(_current);
+		if (sibling != NoNode) {
 
-void
-SlicesTree::Node::addChild(boost::shared_ptr<SlicesTree::Node> sliceNode) {
+			_current = sibling;
+			return *this;
+		}
 
-	_children.push_back(sliceNode);
+		_current = _tree.getParent(_current);
+	}
+
+	_current = NoNode;
+	return *this;
 }
 
-std::vector<boost::shared_ptr<SlicesTree::Node> >
-SlicesTree::Node::getChildren() {
+SlicesTree::PostOrderIterator&
+SlicesTree::PostOrderIterator::operator++() {
+
+	if (_current == _root) {
+
+		_current = NoNode;
+		return *this;
+	}
+
+	// after a node, visit the subtree of its next sibling, or its parent
+	NodeId sibling = _tree.getNextSibling(_current);
+	if (sibling != NoNode)
+		_current = _tree.firstLeaf(sibling);
+	else
+		_current = _tree.getParent(_current);
 
-	return _children;
+	return *this;
 }
 
-boost::shared_ptr<Slice>
-SlicesTree::Node::getSlice() {
+SlicesTree::SlicesTree() :
+	_current(NoNode) {}
+
+void
+SlicesTree::clear() {
+
+	Slices::clear();
 
-	return _slice;
+	_parents.clear();
+	_firstChildren.clear();
+	_nextSiblings.clear();
+	_numChildren.clear();
+	_lastChildren.clear();
+	_roots.clear();
+
+	_current = NoNode;
 }
 
 void
 SlicesTree::addChild(boost::shared_ptr<Slice> slice) {
 
-	boost::shared_ptr<Node> newChild = boost::make_shared<Node>(slice);
+	NodeId newChild = numNodes();
+
+	_parents.push_back(_current);
+	_firstChildren.push_back(NoNode);
+	_nextSiblings.push_back(NoNode);
+	_numChildren.push_back(0);
+	_lastChildren.push_back(NoNode);
 
-	if (!_current) {
+	if (_current == NoNode) {
 
 		LOG_DEBUG(slicestreelog) << "adding new root node for slice " << slice->getId() << std::endl;
 		_roots.push_back(newChild);
 
 	} else {
 
-		LOG_DEBUG(slicestreelog) << "adding slice " << slice->getId()  << " as child of " << _current->getSlice()->getId() << std::endl;
-		_current->addChild(newChild);
-		newChild->setParent(_current);
+		LOG_DEBUG(slicestreelog) << "adding slice " << slice->getId()  << " as child of " << getSlice(_current)->getId() << std::endl;
+
+		if (_lastChildren[_current] == NoNode)
+			_firstChildren[_current] = newChild;
+		else
+			_nextSiblings[_lastChildren[_current]] = newChild;
+
+		_lastChildren[_current] = newChild;
+		_numChildren[_current]++;
 	}
 
 	_current = newChild;
@@ -65,25 +110,29 @@ SlicesTree::leaveChild() {
 
 	LOG_DEBUG(slicestreelog) << "leaving last added child" << std::endl;
 
-	if (_current) {
+	if (_current != NoNode) {
+
+		boost::shared_ptr<Slice> slice = getSlice(_current);
 
-		 LOG_DEBUG(slicestreelog) << "current node was " << _current->getSlice()->getId() << std::endl;
+		LOG_DEBUG(slicestreelog) << "current node was " << slice->getId() << std::endl;
 
 		// set child level and number of descendants
 		unsigned int maxChildLevel  = 0;
 		unsigned int numDescendants = 0;
-		foreach (boost::shared_ptr<SlicesTree::Node> child, _current->getChildren()) {
+		for (NodeId child = _firstChildren[_current]; child != NoNode; child = _nextSiblings[child]) {
 
-			maxChildLevel   = std::max(maxChildLevel, child->getSlice()->getLevel());
-			numDescendants += child->getSlice()->getNumDescendants() + 1;
+			boost::shared_ptr<Slice> childSlice = getSlice(child);
+
+			maxChildLevel   = std::max(maxChildLevel, childSlice->getLevel());
+			numDescendants += childSlice->getNumDescendants() + 1;
 		}
-		_current->getSlice()->setLevel(maxChildLevel + 1);
-		_current->getSlice()->setNumDescendants(numDescendants);
+		slice->setLevel(maxChildLevel + 1);
+		slice->setNumDescendants(numDescendants);
 
-		_current = _current->getParent();
+		_current = _parents[_current];
 
-		if (_current) {
-			 LOG_DEBUG(slicestreelog) << "current node is now " << _current->getSlice()->getId() << std::endl;
+		if (_current != NoNode) {
+			 LOG_DEBUG(slicestreelog) << "current node is now " << getSlice(_current)->getId() << std::endl;
 		} else {
 			 LOG_DEBUG(slicestreelog) << "there is no current node anymore" <<  std::endl;
 		}
@@ -93,3 +142,14 @@ SlicesTree::leaveChild() {
 		LOG_DEBUG(slicestreelog) << "there was no last added child -- something might be wrong" << std::endl;
 	}
 }
+
+SlicesTree::NodeId
+SlicesTree::firstLeaf(NodeId root) const {
+
+	NodeId node = root;
+
+	while (_firstChildren[node] != NoNode)
+		node = _firstChildren[node];
+
+	return node;
+}
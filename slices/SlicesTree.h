@@ -1,75 +1,83 @@
 #ifndef MULTI2CUT_SLICES_SLICES_TREE_H__
 #define MULTI2CUT_SLICES_SLICES_TREE_H__
 
+#include <limits>
+#include <vector>
 #include "Slices.h"
 
+/**
+ * A forest of slices. The nodes are stored in contiguous arrays and referred 
+ * to by their index, which is also the index of the node's slice in the 
+ * underlying Slices. Since nodes are added in depth-first order, the indices 
+ * are a pre-order of the forest.
+ */
 class SlicesTree : public Slices {
 
 public:
 
+	typedef unsigned int NodeId;
+
+	static const NodeId NoNode;
+
 	/**
-	 * A node in the slices tree. Stores the slice and pointers to the children 
-	 * and parent node(s). Pointers to the slice and children are shared 
-	 * pointers, pointers to the parent weak pointers. It is thereby enough to 
-	 * keep the root of the tree alive to ensure that every connected component 
-	 * in the tree is still available.
+	 * Iterates over the nodes of a subtree in pre-order, i.e., parents before 
+	 * their children.
 	 */
-	class Node {
+	class PreOrderIterator {
 
 	public:
 
-		/**
-		 * Create a new node from a slice.
-		 *
-		 * @param component The slice that is to be represented by
-		 *                  this node.
-		 */
-		Node(boost::shared_ptr<Slice> slice);
-
-		/**
-		 * Set the parent of this node.
-		 *
-		 * @param A shared pointer to the new parent.
-		 */
-		void setParent(boost::shared_ptr<Node> parent);
-
-		/**
-		 * Get the parent of this node.
-		 *
-		 * @return The parent of this node.
-		 */
-		boost::shared_ptr<Node> getParent();
-
-		/**
-		 * Add a child to this node.
-		 *
-		 * @param A shared pointer to the new child.
-		 */
-		void addChild(boost::shared_ptr<Node> componentNode);
-
-		/**
-		 * Get all children of this node.
-		 *
-		 * @return A vector of shared pointers to the children of this node.
-		 */
-		std::vector<boost::shared_ptr<Node> > getChildren();
-
-		/**
-		 * Get the slice represented by this node.
-		 *
-		 * @return The slice help by this node.
-		 */
-		boost::shared_ptr<Slice> getSlice();
+		PreOrderIterator(const SlicesTree& tree, NodeId root) :
+			_tree(tree),
+			_root(root),
+			_current(root) {}
+
+		NodeId operator*() const { return _current; }
+
+		bool done() const { return _current == NoNode; }
+
+		PreOrderIterator& operator++();
 
 	private:
 
-		boost::shared_ptr<Slice> _slice;
+		const SlicesTree& _tree;
+		NodeId            _root;
+		NodeId            _current;
+	};
+
+	/**
+	 * Iterates over the nodes of a subtree in post-order, i.e., children 
+	 * before their parents.
+	 */
+	class PostOrderIterator {
+
+	public:
+
+		PostOrderIterator(const SlicesTree& tree, NodeId root) :
+			_tree(tree),
+			_root(root),
+			_current(tree.firstLeaf(root)) {}
 
-		boost::weak_ptr<Node> _parent;
+		NodeId operator*() const { return _current; }
+
+		bool done() const { return _current == NoNode; }
+
+		PostOrderIterator& operator++();
+
+	private:
 
-		std::vector<boost::shared_ptr<Node> > _children;
+		const SlicesTree& _tree;
+		NodeId            _root;
+		NodeId            _current;
 	};
 
+	SlicesTree();
+
+	/**
+	 * Remove all slices and nodes.
+	 */
+	void clear();
+
 	/**
 	 * Add a new slice as a child of the current (i.e., previously added) slice.
 	 */
@@ -81,14 +89,39 @@ public:
 	 */
 	void leaveChild();
 
-	const std::vector<boost::shared_ptr<Node> >& getRoots() const { return _roots; }
+	/**
+	 * The number of nodes, which equals the number of slices.
+	 */
+	unsigned int numNodes() const { return _parents.size(); }
+
+	const std::vector<NodeId>& getRoots() const { return _roots; }
+
+	NodeId getParent(NodeId node) const { return _parents[node]; }
+
+	NodeId getFirstChild(NodeId node) const { return _firstChildren[node]; }
+
+	NodeId getNextSibling(NodeId node) const { return _nextSiblings[node]; }
+
+	unsigned int getNumChildren(NodeId node) const { return _numChildren[node]; }
+
+	boost::shared_ptr<Slice> getSlice(NodeId node) const { return (*this)[node]; }
 
 private:
 
-	std::vector<boost::shared_ptr<Node> > _roots;
+	// the first node of the subtree under root in post-order
+	NodeId firstLeaf(NodeId root) const;
 
-	boost::shared_ptr<Node> _current;
+	std::vector<NodeId>       _parents;
+	std::vector<NodeId>       _firstChildren;
+	std::vector<NodeId>       _nextSiblings;
+	std::vector<unsigned int> _numChildren;
+
+	// the last child of each node, to append siblings
+	std::vector<NodeId>       _lastChildren;
+
+	std::vector<NodeId>       _roots;
+
+	NodeId _current;
 };
 
 #endif // MULTI2CUT_SLICES_SLICES_TREE_H__
-